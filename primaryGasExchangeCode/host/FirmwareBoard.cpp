@@ -0,0 +1,42 @@
+#include "FirmwareBoard.h"
+
+// Pins and calibration as in primaryGasExchangeCode.cpp
+const int BOARD_TFT_CS = D4;
+const int BOARD_TFT_DC = D5;
+const int BOARD_TSC_IRQ = D3;
+const int BOARD_LICOR_PIN = A5;
+const int BOARD_TC_PIN = A2;
+const int BOARD_TS_MINX = 100;
+const int BOARD_TS_MAXX = 3800;
+const int BOARD_TS_MINY = 100;
+const int BOARD_TS_MAXY = 3750;
+
+FirmwareBoard board;
+
+// 420 ppm on the LI-COR's 400 ppm/V output, 25C on the AD8495's 5mV/C around 1.25V
+FirmwareBoard::FirmwareBoard() : base(21.5, 40.0), chamber(24.0, 62.0), lux(850.0), touch(BOARD_TSC_IRQ), display(BOARD_TFT_DC) {
+  co2Volts = 420.0 / 400.0;
+  leafVolts = 1.25 + 25.0 * 0.005;
+}
+
+void attachBoard() {
+  Wire.attach(0x44, &board.base);
+  Wire.attach(0x47, &board.chamber);
+  Wire.attach(0x10, &board.lux);
+  Wire.attach(0x48, &board.touch);
+  SPI.attach(BOARD_TFT_CS, &board.display);
+  Sim::setAnalog(BOARD_LICOR_PIN, [] { return Sim::analogVolts(board.co2Volts); });
+  Sim::setAnalog(BOARD_TC_PIN, [] { return Sim::analogVolts(board.leafVolts); });
+  Sim::setPin(BOARD_TSC_IRQ, HIGH);
+}
+
+// The firmware swaps the panel axes, raw Y runs along the display's x
+void tapDisplay(int x, int y, uint32_t ms) {
+  uint16_t rawX = BOARD_TS_MINX + (y * (BOARD_TS_MAXX - BOARD_TS_MINX) + 319) / 320;
+  uint16_t rawY = BOARD_TS_MINY + (x * (BOARD_TS_MAXY - BOARD_TS_MINY) + 479) / 480;
+
+  board.touch.press(rawX, rawY);
+  Sim::runFirmware(ms);
+  board.touch.release();
+  Sim::runFirmware(ms);
+}
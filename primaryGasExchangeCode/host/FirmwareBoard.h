@@ -0,0 +1,32 @@
+#ifndef _FIRMWAREBOARD_H_
+#define _FIRMWAREBOARD_H_
+
+#include "Particle.h"
+#include "Hdc302xModel.h"
+#include "Hx8357Model.h"
+#include "Tsc2007Model.h"
+#include "Veml7700Model.h"
+
+// The parts primaryGasExchangeCode.cpp talks to, wired the way the board is: both HDC302x,
+// the VEML7700 and the TSC2007 on Wire, the HX8357 on SPI, the LI-COR and leaf thermocouple
+// amplifier on analog pins. attachBoard() before the first Sim::runFirmware().
+struct FirmwareBoard {
+  Hdc302xModel base;
+  Hdc302xModel chamber;
+  Veml7700Model lux;
+  Tsc2007Model touch;
+  Hx8357Model display;
+  float co2Volts;
+  float leafVolts;
+
+  FirmwareBoard();
+};
+
+extern FirmwareBoard board;
+
+void attachBoard();
+
+// Taps the panel at display coordinates x, y (landscape, as the firmware sees them) for ms
+void tapDisplay(int x, int y, uint32_t ms = 100);
+
+#endif // _FIRMWAREBOARD_H_
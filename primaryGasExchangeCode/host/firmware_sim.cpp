@@ -0,0 +1,33 @@
+// Runs the firmware on the simulated board, then writes what the display shows as a PNG and
+// everything sent on Serial (the binary telemetry) to a file for tools/telemetry_decode.py.
+//
+//   firmware_sim [seconds] [screen.png] [serial.bin]
+
+#include "Particle.h"
+#include "FirmwareBoard.h"
+#include "PngWriter.h"
+
+int main(int argc, char **argv) {
+  uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 10) : 30;
+  const char *pngPath = (argc > 2) ? argv[2] : "screen.png";
+  const char *serialPath = (argc > 3) ? argv[3] : "serial.bin";
+  FILE *serial;
+
+  serial = fopen(serialPath, "wb");
+  if(serial == NULL) {
+    fprintf(stderr, "Can't write %s\n", serialPath);
+    return 1;
+  }
+  Serial.captureTo(serial);
+  attachBoard();
+  Sim::runFirmware(seconds * 1000);
+  fclose(serial);
+
+  if(!writePng(pngPath, board.display.screen())) {
+    fprintf(stderr, "Can't write %s\n", pngPath);
+    return 1;
+  }
+  printf("%lu s simulated, %lu I2C transactions, %lu SPI bytes, %u pixels drawn\n", (unsigned long)seconds,
+         (unsigned long)Wire.transactions(), (unsigned long)SPI.bytes(), (unsigned)board.display.pixels());
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include "Hdc302xModel.h"
+
+Hdc302xModel::Hdc302xModel(float temperature, float humidity) {
+  _temperature = temperature;
+  _humidity = humidity;
+  _autoMode = 0;
+  _offsets = 0;
+  _replyLength = 0;
+  _readouts = 0;
+}
+
+void Hdc302xModel::set(float temperature, float humidity) {
+  _temperature = temperature;
+  _humidity = humidity;
+}
+
+// Same polynomial (0x31) and start value (0xFF) as the driver checks
+uint8_t Hdc302xModel::crc8(const uint8_t *data, int length) {
+  uint8_t crc = 0xFF;
+  int i, bit;
+
+  for(i = 0; i < length; i++) {
+    crc ^= data[i];
+    for(bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+void Hdc302xModel::replyWord(uint16_t word) {
+  _reply[0] = word >> 8;
+  _reply[1] = word & 0xFF;
+  _reply[2] = crc8(_reply, 2);
+  _replyLength = 3;
+}
+
+void Hdc302xModel::replyMeasurement() {
+  uint16_t rawT = lroundf(constrain((_temperature + 45) / 175, 0.0f, 1.0f) * 65535);
+  uint16_t rawRH = lroundf(constrain(_humidity / 100, 0.0f, 1.0f) * 65535);
+
+  _reply[0] = rawT >> 8;
+  _reply[1] = rawT & 0xFF;
+  _reply[2] = crc8(_reply, 2);
+  _reply[3] = rawRH >> 8;
+  _reply[4] = rawRH & 0xFF;
+  _reply[5] = crc8(_reply + 3, 2);
+  _replyLength = 6;
+  _readouts++;
+}
+
+bool Hdc302xModel::write(const uint8_t *data, size_t length) {
+  uint16_t command;
+
+  if(length < 2) {
+    return false;
+  }
+  command = (data[0] << 8) | data[1];
+  _replyLength = 0;
+  switch(command) {
+    case 0x30A2: // soft reset
+      _autoMode = 0;
+      return true;
+    case 0x3781: // manufacturer ID
+      replyWord(0x3000);
+      return true;
+    case 0x3683:
+    case 0x3684:
+    case 0x3685: // NIST ID words
+      replyWord(0x1234);
+      return true;
+    case 0xF32D: // status
+      replyWord(0x0000);
+      return true;
+    case 0x3093: // exit auto mode
+      _autoMode = 0;
+      return true;
+    case 0xE000: // auto mode readout, NACKed while asleep
+      if(_autoMode == 0) {
+        return false;
+      }
+      replyMeasurement();
+      return true;
+    case 0xA004: // offsets, written with data or read back
+      if(length == 5) {
+        _offsets = (data[2] << 8) | data[3];
+      }
+      else {
+        replyWord(_offsets);
+      }
+      return true;
+  }
+  if((command >> 8) == 0x24) { // trigger on demand, read once
+    replyMeasurement();
+  }
+  else if((command >> 8) >= 0x20 && (command >> 8) <= 0x27) {
+    _autoMode = command;
+  }
+  return true;
+}
+
+size_t Hdc302xModel::read(uint8_t *data, size_t length) {
+  if(_replyLength == 0) {
+    return 0; // nothing to read NACKs
+  }
+  if(length > _replyLength) {
+    length = _replyLength;
+  }
+  memcpy(data, _reply, length);
+  if(_autoMode == 0) {
+    _replyLength = 0; // a triggered result is read once
+  }
+  return length;
+}
@@ -0,0 +1,35 @@
+#ifndef _HDC302XMODEL_H_
+#define _HDC302XMODEL_H_
+
+#include "Particle.h"
+
+// HDC302x temperature/humidity sensor as the driver sees it over I2C: 16-bit commands, words
+// read back with their CRC-8. Auto mode readouts NACK until an auto mode has been started, like
+// the chip. set() changes what the next measurement reports.
+class Hdc302xModel : public SimI2cDevice {
+
+  float _temperature;
+  float _humidity;
+  uint16_t _autoMode;     // command that started it, 0 while sleeping
+  uint16_t _offsets;
+  uint8_t _reply[6];
+  size_t _replyLength;
+  uint32_t _readouts;
+
+  void replyWord(uint16_t word);
+  void replyMeasurement();
+
+  public:
+    Hdc302xModel(float temperature = 22.0, float humidity = 45.0);
+
+    void set(float temperature, float humidity);
+    uint16_t autoMode() { return _autoMode; }
+    uint32_t readouts() { return _readouts; }
+
+    bool write(const uint8_t *data, size_t length);
+    size_t read(uint8_t *data, size_t length);
+
+    static uint8_t crc8(const uint8_t *data, int length);
+};
+
+#endif // _HDC302XMODEL_H_
@@ -0,0 +1,114 @@
+#include "Hx8357Model.h"
+
+const uint8_t HX_CASET = 0x2A;
+const uint8_t HX_PASET = 0x2B;
+const uint8_t HX_RAMWR = 0x2C;
+const uint8_t HX_RAMWR_CONTINUE = 0x3C;
+const uint8_t HX_MADCTL = 0x36;
+
+const uint8_t HX_MADCTL_MY = 0x80;
+const uint8_t HX_MADCTL_MX = 0x40;
+const uint8_t HX_MADCTL_MV = 0x20;
+
+Hx8357Model::Hx8357Model(int dcPin) : _ram(HX8357_RAM_W, HX8357_RAM_H) {
+  _dcPin = dcPin;
+  _command = 0;
+  _argCount = 0;
+  _madctl = HX_MADCTL_MX | HX_MADCTL_MY;
+  _xStart = _yStart = 0;
+  _xEnd = HX8357_RAM_W - 1;
+  _yEnd = HX8357_RAM_H - 1;
+  _x = _y = 0;
+  _haveHigh = false;
+  _pixels = 0;
+  _commands = 0;
+}
+
+uint8_t Hx8357Model::transfer(uint8_t out) {
+  if(digitalRead(_dcPin) == LOW) {
+    command(out);
+  }
+  else {
+    data(out);
+  }
+  return 0;
+}
+
+void Hx8357Model::command(uint8_t command) {
+  _command = command;
+  _argCount = 0;
+  _haveHigh = false;
+  _commands++;
+  if(command == HX_RAMWR) {
+    _x = _xStart;
+    _y = _yStart;
+  }
+}
+
+void Hx8357Model::data(uint8_t value) {
+  switch(_command) {
+    case HX_CASET:
+    case HX_PASET:
+      if(_argCount < 4) {
+        _args[_argCount++] = value;
+      }
+      if(_argCount == 4 && _command == HX_CASET) {
+        _xStart = (_args[0] << 8) | _args[1];
+        _xEnd = (_args[2] << 8) | _args[3];
+      }
+      else if(_argCount == 4) {
+        _yStart = (_args[0] << 8) | _args[1];
+        _yEnd = (_args[2] << 8) | _args[3];
+      }
+      break;
+    case HX_MADCTL:
+      _madctl = value;
+      // The GFX rotation whose MADCTL this is (Adafruit_HX8357::setRotation())
+      switch(value & (HX_MADCTL_MY | HX_MADCTL_MX | HX_MADCTL_MV)) {
+        case HX_MADCTL_MV | HX_MADCTL_MY: _ram.setRotation(1); break;
+        case 0: _ram.setRotation(2); break;
+        case HX_MADCTL_MV | HX_MADCTL_MX: _ram.setRotation(3); break;
+        default: _ram.setRotation(0); break;
+      }
+      break;
+    case HX_RAMWR:
+    case HX_RAMWR_CONTINUE:
+      if(!_haveHigh) {
+        _pixelHigh = value;
+        _haveHigh = true;
+      }
+      else {
+        writePixel((_pixelHigh << 8) | value);
+        _haveHigh = false;
+      }
+      break;
+  }
+}
+
+// The window counters run in the rotated space, MV swaps them onto the RAM axes and MX/MY
+// mirror those. RAM address 0,0 is the opposite corner from GFX's rotation 0 origin.
+void Hx8357Model::writePixel(uint16_t color) {
+  int column, row;
+
+  column = (_madctl & HX_MADCTL_MV) ? _y : _x;
+  row = (_madctl & HX_MADCTL_MV) ? _x : _y;
+  if(_madctl & HX_MADCTL_MX) {
+    column = HX8357_RAM_W - 1 - column;
+  }
+  if(_madctl & HX_MADCTL_MY) {
+    row = HX8357_RAM_H - 1 - row;
+  }
+  column = HX8357_RAM_W - 1 - column;
+  row = HX8357_RAM_H - 1 - row;
+  if(column >= 0 && column < HX8357_RAM_W && row >= 0 && row < HX8357_RAM_H) {
+    _ram.getBuffer()[row * HX8357_RAM_W + column] = color;
+  }
+  _pixels++;
+
+  if(_x < _xEnd) {
+    _x++;
+    return;
+  }
+  _x = _xStart;
+  _y = (_y < _yEnd) ? _y + 1 : _yStart;
+}
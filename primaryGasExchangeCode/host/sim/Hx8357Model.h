@@ -0,0 +1,47 @@
+#ifndef _HX8357MODEL_H_
+#define _HX8357MODEL_H_
+
+#include "Particle.h"
+#include "Adafruit_GFX.h"
+
+const int HX8357_RAM_W = 320; // panel RAM, portrait
+const int HX8357_RAM_H = 480;
+
+// HX8357D display controller on SPI. Bytes with DC low are commands, the ones after are their
+// parameters. CASET/PASET set the address window, RAMWR streams big endian RGB565 pixels into it
+// and MADCTL's MV/MX/MY decide where they land in the panel RAM.
+//
+// The RAM is a GFXcanvas16 kept in the orientation GFX calls rotation 0 (MADCTL MX|MY on this
+// panel), with the canvas rotation following MADCTL. So screen()->getPixel(x, y) is the pixel
+// the firmware drew at x, y, and writePng(screen()) is what the panel shows.
+class Hx8357Model : public SimSpiDevice {
+
+  GFXcanvas16 _ram;
+  int _dcPin;
+  uint8_t _command;
+  uint8_t _args[4];
+  int _argCount;
+  uint8_t _madctl;
+  uint16_t _xStart, _xEnd, _yStart, _yEnd;
+  uint16_t _x, _y;
+  uint8_t _pixelHigh;
+  bool _haveHigh;
+  uint32_t _pixels;
+  uint32_t _commands;
+
+  void command(uint8_t command);
+  void data(uint8_t value);
+  void writePixel(uint16_t color);
+
+  public:
+    Hx8357Model(int dcPin);
+
+    GFXcanvas16 *screen() { return &_ram; }
+    uint16_t pixel(int16_t x, int16_t y) { return _ram.getPixel(x, y); }
+    uint32_t pixels() { return _pixels; }
+    uint32_t commands() { return _commands; }
+
+    uint8_t transfer(uint8_t out);
+};
+
+#endif // _HX8357MODEL_H_
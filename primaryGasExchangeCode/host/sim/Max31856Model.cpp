@@ -0,0 +1,66 @@
+#include "Max31856Model.h"
+
+// Power on values, datasheet table 6
+const uint8_t MAX31856_DEFAULTS[16] = {0x00, 0x03, 0xFF, 0x7F, 0xC0, 0x7F, 0xFF, 0x80, 0x00, 0x00, 0, 0, 0, 0, 0, 0};
+
+Max31856Model::Max31856Model(float thermocouple, float coldJunction) {
+  memcpy(_registers, MAX31856_DEFAULTS, sizeof(_registers));
+  _address = 0;
+  _started = false;
+  _writing = false;
+  _thermocouple = thermocouple;
+  _coldJunction = coldJunction;
+  _conversions = 0;
+}
+
+void Max31856Model::setTemperatures(float thermocouple, float coldJunction) {
+  _thermocouple = thermocouple;
+  _coldJunction = coldJunction;
+}
+
+// Cold junction in 1/256 degC steps (14 bits used), thermocouple in 1/128 degC steps as 19 bits
+// at the top of 24
+void Max31856Model::convert() {
+  int16_t cj = (int16_t)lroundf(_coldJunction * 64) * 4;
+  int32_t tc = (int32_t)lroundf(_thermocouple * 128) * 32;
+
+  _registers[0x0A] = (uint16_t)cj >> 8;
+  _registers[0x0B] = cj & 0xFF;
+  _registers[0x0C] = (tc >> 16) & 0xFF;
+  _registers[0x0D] = (tc >> 8) & 0xFF;
+  _registers[0x0E] = tc & 0xFF;
+  _registers[0] &= ~0x40; // the one-shot bit clears itself
+  _conversions++;
+}
+
+uint8_t Max31856Model::transfer(uint8_t out) {
+  uint8_t in;
+
+  if(!_started) {
+    _started = true;
+    _writing = out & 0x80;
+    _address = out & 0x0F;
+    if(!_writing && _address >= 0x0A && (_registers[0] & 0x80)) {
+      convert(); // auto conversion mode always has a fresh result
+    }
+    return 0xFF;
+  }
+  if(_writing) {
+    if(_address < 0x0A || _address == 0x0F) {
+      _registers[_address] = out;
+    }
+    if(_address == 0 && (out & 0x40)) {
+      convert();
+    }
+    in = 0xFF;
+  }
+  else {
+    in = _registers[_address];
+  }
+  _address = (_address + 1) & 0x0F;
+  return in;
+}
+
+void Max31856Model::deselect() {
+  _started = false;
+}
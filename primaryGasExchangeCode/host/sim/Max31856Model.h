@@ -0,0 +1,33 @@
+#ifndef _MAX31856MODEL_H_
+#define _MAX31856MODEL_H_
+
+#include "Particle.h"
+
+// MAX31856 thermocouple converter on SPI: an address byte (bit 7 set to write), then data with
+// the address counting up. A one-shot (CR0 bit 6) or auto conversion loads the temperatures set
+// with setTemperatures() into the result registers, encoded as the datasheet gives them.
+class Max31856Model : public SimSpiDevice {
+
+  uint8_t _registers[16];
+  uint8_t _address;
+  bool _started;
+  bool _writing;
+  float _thermocouple;
+  float _coldJunction;
+  uint32_t _conversions;
+
+  void convert();
+
+  public:
+    Max31856Model(float thermocouple = 25.0, float coldJunction = 24.0);
+
+    void setTemperatures(float thermocouple, float coldJunction);
+    void setFault(uint8_t fault) { _registers[0x0F] = fault; }
+    uint8_t reg(uint8_t address) { return _registers[address & 0x0F]; }
+    uint32_t conversions() { return _conversions; }
+
+    uint8_t transfer(uint8_t out);
+    void deselect();
+};
+
+#endif // _MAX31856MODEL_H_
@@ -0,0 +1,90 @@
+#include "PngWriter.h"
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length) {
+  size_t i;
+  int bit;
+
+  crc = ~crc;
+  for(i = 0; i < length; i++) {
+    crc ^= data[i];
+    for(bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+static void put32(std::string *out, uint32_t value) {
+  out->push_back(value >> 24);
+  out->push_back((value >> 16) & 0xFF);
+  out->push_back((value >> 8) & 0xFF);
+  out->push_back(value & 0xFF);
+}
+
+static void chunk(std::string *out, const char *type, const std::string &data) {
+  std::string body(type, 4);
+
+  body += data;
+  put32(out, data.size());
+  *out += body;
+  put32(out, crc32(0, (const uint8_t *)body.data(), body.size()));
+}
+
+bool writePng(const char *path, GFXcanvas16 *canvas) {
+  const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  int width = canvas->width();
+  int height = canvas->height();
+  std::string raw, header, zlib, file;
+  uint32_t adlerA = 1, adlerB = 0;
+  uint16_t color;
+  size_t at, block;
+  int x, y;
+  FILE *f;
+
+  // Every row starts with filter type 0, then RGB565 widened to 8 bits a channel
+  for(y = 0; y < height; y++) {
+    raw.push_back(0);
+    for(x = 0; x < width; x++) {
+      color = canvas->getPixel(x, y);
+      raw.push_back(((color >> 11) * 527 + 23) >> 6);
+      raw.push_back((((color >> 5) & 0x3F) * 259 + 33) >> 6);
+      raw.push_back(((color & 0x1F) * 527 + 23) >> 6);
+    }
+  }
+
+  zlib.push_back(0x78);
+  zlib.push_back(0x01);
+  for(at = 0; at < raw.size(); at += block) {
+    block = std::min(raw.size() - at, (size_t)65535);
+    zlib.push_back((at + block == raw.size()) ? 1 : 0);
+    zlib.push_back(block & 0xFF);
+    zlib.push_back(block >> 8);
+    zlib.push_back(~block & 0xFF);
+    zlib.push_back((~block >> 8) & 0xFF);
+    zlib.append(raw, at, block);
+  }
+  for(uint8_t c : raw) {
+    adlerA = (adlerA + c) % 65521;
+    adlerB = (adlerB + adlerA) % 65521;
+  }
+  put32(&zlib, (adlerB << 16) | adlerA);
+
+  put32(&header, width);
+  put32(&header, height);
+  header += std::string("\x08\x02\x00\x00\x00", 5); // 8 bits, RGB, deflate, no filter, no interlace
+
+  file.assign((const char *)signature, sizeof(signature));
+  chunk(&file, "IHDR", header);
+  chunk(&file, "IDAT", zlib);
+  chunk(&file, "IEND", "");
+
+  f = fopen(path, "wb");
+  if(f == NULL) {
+    return false;
+  }
+  if(fwrite(file.data(), 1, file.size(), f) != file.size()) {
+    fclose(f);
+    return false;
+  }
+  return fclose(f) == 0;
+}
@@ -0,0 +1,12 @@
+#ifndef _PNGWRITER_H_
+#define _PNGWRITER_H_
+
+#include "Particle.h"
+#include "Adafruit_GFX.h"
+
+// Writes a canvas as an 8-bit RGB PNG, read through getPixel() so the canvas rotation applies.
+// The image data goes in stored (uncompressed) deflate blocks, which every PNG reader takes and
+// needs no zlib. False if the file couldn't be written.
+bool writePng(const char *path, GFXcanvas16 *canvas);
+
+#endif // _PNGWRITER_H_
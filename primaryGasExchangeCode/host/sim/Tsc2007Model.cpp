@@ -0,0 +1,71 @@
+#include "Tsc2007Model.h"
+
+Tsc2007Model::Tsc2007Model(int irqPin) {
+  _irqPin = irqPin;
+  _down = false;
+  _x = _y = 0xFFF;
+  _z1 = 0;
+  _irqEnabled = true;
+  _replyLength = 0;
+  _conversions = 0;
+}
+
+void Tsc2007Model::press(uint16_t x, uint16_t y, uint16_t z1) {
+  _down = true;
+  _x = x;
+  _y = y;
+  _z1 = z1;
+  updateIrq();
+}
+
+void Tsc2007Model::release() {
+  _down = false;
+  _x = _y = 0xFFF;
+  _z1 = 0;
+  updateIrq();
+}
+
+// PENIRQ is open drain, high unless the pen is down with the IRQ enabled
+void Tsc2007Model::updateIrq() {
+  Sim::setPin(_irqPin, (_down && _irqEnabled) ? LOW : HIGH);
+}
+
+// Command byte: function C3..C0, power down mode PD1..PD0, M (8 bit), X
+bool Tsc2007Model::write(const uint8_t *data, size_t length) {
+  uint8_t function, power;
+  uint16_t value;
+
+  if(length < 1) {
+    return false;
+  }
+  function = data[0] >> 4;
+  power = (data[0] >> 2) & 0x03;
+  switch(function) {
+    case 12: value = _x; break;
+    case 13: value = _y; break;
+    case 14: value = _z1; break;
+    case 15: value = _down ? 4095 - _z1 : 0; break;
+    default: value = 0x800; break; // temperature and aux, nothing uses them
+  }
+  _conversions++;
+  if(data[0] & 0x02) {
+    _reply[0] = value >> 4;
+    _replyLength = 1;
+  }
+  else {
+    _reply[0] = value >> 4;
+    _reply[1] = (value & 0x0F) << 4;
+    _replyLength = 2;
+  }
+  _irqEnabled = (power == 0 || power == 2);
+  updateIrq();
+  return true;
+}
+
+size_t Tsc2007Model::read(uint8_t *data, size_t length) {
+  if(length > _replyLength) {
+    length = _replyLength;
+  }
+  memcpy(data, _reply, length);
+  return length;
+}
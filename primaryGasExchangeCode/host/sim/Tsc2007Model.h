@@ -0,0 +1,33 @@
+#ifndef _TSC2007MODEL_H_
+#define _TSC2007MODEL_H_
+
+#include "Particle.h"
+
+// TSC2007 resistive touch controller: a command byte starts a conversion, the result is read
+// back as 12 (or 8) bits. While the pen is down and the last command left PENIRQ enabled, the
+// model pulls irqPin low, which is what wakes TouchEvents.
+class Tsc2007Model : public SimI2cDevice {
+
+  int _irqPin;
+  bool _down;
+  uint16_t _x, _y, _z1;
+  bool _irqEnabled;
+  uint8_t _reply[2];
+  size_t _replyLength;
+  uint32_t _conversions;
+
+  void updateIrq();
+
+  public:
+    Tsc2007Model(int irqPin);
+
+    // Raw 12-bit panel readings, z1 is the pressure
+    void press(uint16_t x, uint16_t y, uint16_t z1 = 400);
+    void release();
+    uint32_t conversions() { return _conversions; }
+
+    bool write(const uint8_t *data, size_t length);
+    size_t read(uint8_t *data, size_t length);
+};
+
+#endif // _TSC2007MODEL_H_
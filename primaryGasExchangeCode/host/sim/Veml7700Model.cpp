@@ -0,0 +1,69 @@
+#include "Veml7700Model.h"
+
+const float VEML_LUX_PER_COUNT = 0.0576; // gain 1, 100ms, what the driver multiplies by
+
+Veml7700Model::Veml7700Model(float lux) {
+  memset(_registers, 0, sizeof(_registers));
+  _registers[0] = 0x0001; // shut down at power on
+  _registers[7] = 0xC481; // device ID
+  _pointer = 0;
+  _lux = lux;
+  _dataReads = 0;
+}
+
+// Counts the current setting gives for the lux, 0 while shut down
+uint16_t Veml7700Model::counts() {
+  uint16_t config = _registers[0];
+  const float gains[] = {1.0, 2.0, 0.125, 0.25};
+  float integration;
+  float value;
+
+  if(config & 0x0001) {
+    return 0;
+  }
+  switch((config >> 6) & 0x0F) {
+    case 0x0C: integration = 0.25; break;
+    case 0x08: integration = 0.5; break;
+    case 0x01: integration = 2.0; break;
+    case 0x02: integration = 4.0; break;
+    case 0x03: integration = 8.0; break;
+    default: integration = 1.0; break;
+  }
+  value = _lux / VEML_LUX_PER_COUNT * gains[(config >> 11) & 0x03] * integration;
+  return (value >= 65535) ? 65535 : lroundf(value);
+}
+
+uint16_t Veml7700Model::register16(uint8_t reg) {
+  if(reg == 0x04 || reg == 0x05) {
+    _dataReads++;
+    return counts();
+  }
+  return (reg < 8) ? _registers[reg] : 0;
+}
+
+// The command code, then two data bytes for a register write
+bool Veml7700Model::write(const uint8_t *data, size_t length) {
+  if(length < 1 || data[0] > 7) {
+    return false;
+  }
+  _pointer = data[0];
+  if(length >= 3 && _pointer <= 3) {
+    _registers[_pointer] = data[1] | (data[2] << 8);
+  }
+  return true;
+}
+
+size_t Veml7700Model::read(uint8_t *data, size_t length) {
+  uint16_t value = register16(_pointer);
+
+  if(length > 2) {
+    length = 2;
+  }
+  if(length > 0) {
+    data[0] = value & 0xFF;
+  }
+  if(length > 1) {
+    data[1] = value >> 8;
+  }
+  return length;
+}
@@ -0,0 +1,30 @@
+#ifndef _VEML7700MODEL_H_
+#define _VEML7700MODEL_H_
+
+#include "Particle.h"
+
+// VEML7700 ambient light sensor: 16-bit little endian registers behind a command code. The ALS
+// count follows the configured gain and integration time for the lux set with setLux(), and
+// saturates at 65535 like the real part.
+class Veml7700Model : public SimI2cDevice {
+
+  uint16_t _registers[8];
+  uint8_t _pointer;
+  float _lux;
+  uint32_t _dataReads;
+
+  uint16_t register16(uint8_t reg);
+
+  public:
+    Veml7700Model(float lux = 300.0);
+
+    void setLux(float lux) { _lux = lux; }
+    uint16_t config() { return _registers[0]; }
+    uint32_t dataReads() { return _dataReads; }
+    uint16_t counts();
+
+    bool write(const uint8_t *data, size_t length);
+    size_t read(uint8_t *data, size_t length);
+};
+
+#endif // _VEML7700MODEL_H_
@@ -0,0 +1,821 @@
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "Particle.h"
+
+USBSerial Serial;
+TwoWire Wire;
+SPIClass SPI;
+SPIClass SPI1;
+SystemClass System;
+CloudClass Particle;
+TimeClass Time;
+
+uint64_t Sim::_nanos = 0;
+bool Sim::_inTimer = false;
+
+struct SimPin {
+  uint8_t level;
+  PinMode mode;
+  void (*handler)();
+  InterruptMode edge;
+  std::function<int32_t(void)> analog;
+};
+
+// Function statics, the firmware's globals register with these from their constructors
+static SimPin *pinAt(uint16_t pin) {
+  static SimPin pins[TOTAL_PINS];
+
+  return (pin < TOTAL_PINS) ? &pins[pin] : NULL;
+}
+
+static std::vector<Timer *> &timers() {
+  static std::vector<Timer *> list;
+
+  return list;
+}
+
+static std::vector<SPIClass *> &spiBuses() {
+  static std::vector<SPIClass *> list;
+
+  return list;
+}
+
+// The first thread to touch the clock is main(), or static init before it
+static bool onMainThread() {
+  static const std::thread::id mainThread = std::this_thread::get_id();
+
+  return std::this_thread::get_id() == mainThread;
+}
+
+static std::vector<SimEvent> events;
+static bool cloudReachable = true;
+static bool cloudAccepting = true;
+static bool cloudConnected = false;
+static bool timeSynced = false;
+static time32_t unixAtZero = 1760000000; // 2025-10-09, any synced time will do
+
+// Time
+
+// Fires the timers that come due on the way, in order. Nested calls (a timer callback that
+// waits) only move the clock, like a callback holding up the Device OS timer thread.
+void Sim::advance(uint64_t nanos) {
+  uint64_t target = _nanos + nanos;
+  Timer *next;
+
+  if(!onMainThread()) {
+    // Only the main thread owns simulated time, a worker thread just yields for real
+    std::this_thread::sleep_for(std::chrono::microseconds(nanos / 1000 + 1));
+    return;
+  }
+  if(_inTimer) {
+    _nanos = target;
+    return;
+  }
+  while(true) {
+    next = NULL;
+    for(Timer *timer : timers()) {
+      if(timer->_active && timer->_due <= target && (next == NULL || timer->_due < next->_due)) {
+        next = timer;
+      }
+    }
+    if(next == NULL) {
+      break;
+    }
+    if(next->_due > _nanos) {
+      _nanos = next->_due;
+    }
+    if(next->_oneShot) {
+      next->_active = false;
+    }
+    else {
+      next->_due += (uint64_t)next->_period * 1000000;
+    }
+    _inTimer = true;
+    next->_callback();
+    _inTimer = false;
+  }
+  if(target > _nanos) {
+    _nanos = target;
+  }
+}
+
+system_tick_t millis() {
+  return Sim::nanos() / 1000000;
+}
+
+unsigned long micros() {
+  return Sim::nanos() / 1000;
+}
+
+void delay(unsigned long ms) {
+  Sim::advance((uint64_t)ms * 1000000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  Sim::advance((uint64_t)us * 1000);
+}
+
+Timer::Timer(unsigned period, void (*callback)(void), bool oneShot) {
+  _callback = callback;
+  _period = period;
+  _oneShot = oneShot;
+  _active = false;
+  _due = 0;
+  timers().push_back(this);
+}
+
+Timer::~Timer() {
+  timers().erase(std::remove(timers().begin(), timers().end(), this), timers().end());
+}
+
+bool Timer::start() {
+  _active = true;
+  _due = Sim::nanos() + (uint64_t)_period * 1000000;
+  return true;
+}
+
+bool Timer::stop() {
+  _active = false;
+  return true;
+}
+
+bool Timer::changePeriod(unsigned period) {
+  _period = period;
+  return start();
+}
+
+// GPIO
+
+void pinMode(uint16_t pin, PinMode mode) {
+  SimPin *p = pinAt(pin);
+
+  if(p == NULL) {
+    return;
+  }
+  p->mode = mode;
+  if(mode == INPUT_PULLUP) {
+    p->level = HIGH;
+  }
+  else if(mode == INPUT_PULLDOWN) {
+    p->level = LOW;
+  }
+}
+
+void digitalWrite(uint16_t pin, uint8_t value) {
+  SimPin *p = pinAt(pin);
+
+  if(p == NULL) {
+    return;
+  }
+  value = value ? HIGH : LOW;
+  if(p->level != value) {
+    p->level = value;
+    for(SPIClass *bus : spiBuses()) {
+      bus->chipSelect(pin, value);
+    }
+  }
+}
+
+int32_t digitalRead(uint16_t pin) {
+  SimPin *p = pinAt(pin);
+
+  return (p == NULL) ? LOW : p->level;
+}
+
+int32_t analogRead(uint16_t pin) {
+  SimPin *p = pinAt(pin);
+
+  if(p == NULL || !p->analog) {
+    return 0;
+  }
+  return constrain(p->analog(), 0, 4095);
+}
+
+bool attachInterrupt(uint16_t pin, void (*handler)(), InterruptMode mode, int8_t priority, uint8_t subpriority) {
+  SimPin *p = pinAt(pin);
+
+  if(p == NULL) {
+    return false;
+  }
+  p->handler = handler;
+  p->edge = mode;
+  return true;
+}
+
+void detachInterrupt(uint16_t pin) {
+  SimPin *p = pinAt(pin);
+
+  if(p != NULL) {
+    p->handler = NULL;
+  }
+}
+
+void noInterrupts() {}
+
+void interrupts() {}
+
+int map(int value, int fromStart, int fromEnd, int toStart, int toEnd) {
+  if(fromEnd == fromStart) {
+    return toStart;
+  }
+  return (value - fromStart) * (toEnd - toStart) / (fromEnd - fromStart) + toStart;
+}
+
+double map(double value, double fromStart, double fromEnd, double toStart, double toEnd) {
+  if(fromEnd == fromStart) {
+    return toStart;
+  }
+  return (value - fromStart) * (toEnd - toStart) / (fromEnd - fromStart) + toStart;
+}
+
+void Sim::setPin(uint16_t pin, uint8_t level) {
+  SimPin *p = pinAt(pin);
+  uint8_t previous;
+
+  if(p == NULL) {
+    return;
+  }
+  previous = p->level;
+  p->level = level ? HIGH : LOW;
+  if(p->handler == NULL || previous == p->level) {
+    return;
+  }
+  if(p->edge == CHANGE || (p->edge == RISING && p->level == HIGH) || (p->edge == FALLING && p->level == LOW)) {
+    p->handler();
+  }
+}
+
+uint8_t Sim::pin(uint16_t pin) {
+  return digitalRead(pin);
+}
+
+PinMode Sim::mode(uint16_t pin) {
+  SimPin *p = pinAt(pin);
+
+  return (p == NULL) ? INPUT : p->mode;
+}
+
+void Sim::setAnalog(uint16_t pin, int32_t counts) {
+  setAnalog(pin, [counts]() { return counts; });
+}
+
+void Sim::setAnalog(uint16_t pin, std::function<int32_t(void)> source) {
+  SimPin *p = pinAt(pin);
+
+  if(p != NULL) {
+    p->analog = source;
+  }
+}
+
+// Cloud and time
+
+void Sim::setCloud(bool reachable, bool accepting) {
+  cloudReachable = reachable;
+  cloudAccepting = accepting;
+}
+
+void Sim::setUnixTime(time32_t now) {
+  unixAtZero = now - (time32_t)(_nanos / 1000000000);
+}
+
+std::vector<SimEvent> &Sim::published() {
+  return events;
+}
+
+void Sim::reset() {
+  int i;
+
+  _nanos = 0;
+  for(i = 0; i < TOTAL_PINS; i++) {
+    *pinAt(i) = SimPin();
+  }
+  events.clear();
+  cloudReachable = true;
+  cloudAccepting = true;
+  cloudConnected = false;
+  timeSynced = false;
+  Serial.clearOutput();
+  Wire.resetCounts();
+  SPI.resetCounts();
+  SPI1.resetCounts();
+}
+
+// Device OS syncs the clock as soon as the cloud connection is up
+void CloudClass::connect() {
+  cloudConnected = true;
+  if(cloudReachable) {
+    timeSynced = true;
+  }
+}
+
+void CloudClass::disconnect() {
+  cloudConnected = false;
+}
+
+bool CloudClass::connected() {
+  if(cloudConnected && cloudReachable) {
+    timeSynced = true;
+    return true;
+  }
+  return false;
+}
+
+bool CloudClass::publish(const char *event, const char *data, PublishFlag flag1, PublishFlag flag2) {
+  if(!connected() || !cloudAccepting) {
+    return false;
+  }
+  events.push_back({event, data, millis()});
+  return true;
+}
+
+time32_t TimeClass::now() {
+  return unixAtZero + (time32_t)(Sim::nanos() / 1000000000);
+}
+
+bool TimeClass::isValid() {
+  return timeSynced;
+}
+
+// System events
+
+bool SystemClass::on(system_event_t events, system_event_handler_t handler) {
+  _handlers.push_back({events, handler});
+  return true;
+}
+
+void SystemClass::reset() {
+  for(auto &handler : _handlers) {
+    if(handler.first & ::reset) {
+      handler.second(::reset, 0);
+    }
+  }
+}
+
+// Threads and queues
+
+struct SimQueue {
+  std::mutex lock;
+  std::condition_variable changed;
+  std::deque<std::string> items;
+  size_t itemSize;
+  size_t capacity;
+};
+
+// Waits for ready() under the queue's lock, delay real ms or forever
+template <class F> static bool waitOn(SimQueue *q, std::unique_lock<std::mutex> &held, system_tick_t delay, F ready) {
+  if(delay == CONCURRENT_WAIT_FOREVER) {
+    q->changed.wait(held, ready);
+    return true;
+  }
+  return q->changed.wait_for(held, std::chrono::milliseconds(delay), ready);
+}
+
+int os_queue_create(os_queue_t *queue, size_t item_size, size_t item_count, void *reserved) {
+  SimQueue *q = new SimQueue();
+
+  q->itemSize = item_size;
+  q->capacity = item_count;
+  *queue = q;
+  return 0;
+}
+
+int os_queue_put(os_queue_t queue, const void *item, system_tick_t delay, void *reserved) {
+  SimQueue *q = (SimQueue *)queue;
+  std::unique_lock<std::mutex> held(q->lock);
+
+  if(!waitOn(q, held, delay, [q] { return q->items.size() < q->capacity; })) {
+    return 1;
+  }
+  q->items.push_back(std::string((const char *)item, q->itemSize));
+  q->changed.notify_all();
+  return 0;
+}
+
+int os_queue_take(os_queue_t queue, void *item, system_tick_t delay, void *reserved) {
+  SimQueue *q = (SimQueue *)queue;
+  std::unique_lock<std::mutex> held(q->lock);
+
+  if(!waitOn(q, held, delay, [q] { return !q->items.empty(); })) {
+    return 1;
+  }
+  memcpy(item, q->items.front().data(), q->itemSize);
+  q->items.pop_front();
+  q->changed.notify_all();
+  return 0;
+}
+
+int os_queue_destroy(os_queue_t queue, void *reserved) {
+  delete (SimQueue *)queue;
+  return 0;
+}
+
+// The thread function returns right after, which ends the std::thread
+void os_thread_exit(void *reserved) {
+}
+
+struct Thread::Running {
+  std::thread thread;
+};
+
+Thread::Thread(const char *name, os_thread_fn_t function, void *function_param, os_thread_prio_t priority, size_t stack_size) {
+  _running = new Running();
+  _running->thread = std::thread(function, function_param);
+}
+
+// Device OS lets a running thread's object go, the thread carries on
+Thread::~Thread() {
+  if(_running != NULL && _running->thread.joinable()) {
+    _running->thread.detach();
+  }
+  delete _running;
+}
+
+bool Thread::join() {
+  if(_running == NULL || !_running->thread.joinable()) {
+    return false;
+  }
+  _running->thread.join();
+  return true;
+}
+
+// String
+
+String::String(int value, int base) : String((long)value, base) {}
+
+String::String(unsigned int value, int base) : String((unsigned long)value, base) {}
+
+String::String(long value, int base) {
+  if(value < 0 && base == DEC) {
+    _s = "-" + String((unsigned long)-value, base)._s;
+  }
+  else {
+    _s = String((unsigned long)value, base)._s;
+  }
+}
+
+String::String(unsigned long value, int base) {
+  const char *digits = "0123456789ABCDEF";
+
+  do {
+    _s.insert(_s.begin(), digits[value % base]);
+    value /= base;
+  } while(value > 0);
+}
+
+String::String(double value, int decimals) {
+  char text[40];
+
+  snprintf(text, sizeof(text), "%.*f", decimals, value);
+  _s = text;
+}
+
+int String::indexOf(const char *s, unsigned int from) const {
+  size_t at = _s.find(s, from);
+
+  return (at == std::string::npos) ? -1 : (int)at;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t at = _s.find(c, from);
+
+  return (at == std::string::npos) ? -1 : (int)at;
+}
+
+String String::substring(unsigned int from) const {
+  return (from >= _s.length()) ? String() : String(_s.substr(from));
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if(to > _s.length()) {
+    to = _s.length();
+  }
+  return (from >= to) ? String() : String(_s.substr(from, to - from));
+}
+
+// Print and Stream
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t written = 0;
+
+  while(size--) {
+    written += write(*buffer++);
+  }
+  return written;
+}
+
+size_t Print::printNumber(unsigned long value, int base) {
+  return print(String(value, (base < 2) ? DEC : base));
+}
+
+size_t Print::print(long value, int base) {
+  if(base == DEC) {
+    return print(String(value, base));
+  }
+  return printNumber((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return printNumber(value, base);
+}
+
+size_t Print::print(double value, int decimals) {
+  return print(String(value, decimals));
+}
+
+size_t Print::vprintf(bool newline, const char *format, va_list args) {
+  char text[256];
+  std::string longer;
+  va_list again;
+  int n;
+
+  va_copy(again, args);
+  n = vsnprintf(text, sizeof(text), format, args);
+  if(n < 0) {
+    va_end(again);
+    return 0;
+  }
+  if((size_t)n < sizeof(text)) {
+    write((const uint8_t *)text, n);
+  }
+  else {
+    longer.resize(n + 1);
+    vsnprintf(&longer[0], n + 1, format, again);
+    write((const uint8_t *)longer.data(), n);
+  }
+  va_end(again);
+  if(newline) {
+    n += println();
+  }
+  return n;
+}
+
+size_t Print::printf(const char *format, ...) {
+  va_list args;
+  size_t n;
+
+  va_start(args, format);
+  n = vprintf(false, format, args);
+  va_end(args);
+  return n;
+}
+
+size_t Print::printlnf(const char *format, ...) {
+  va_list args;
+  size_t n;
+
+  va_start(args, format);
+  n = vprintf(true, format, args);
+  va_end(args);
+  return n;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t n = 0;
+  int c;
+
+  while(n < length && (c = read()) >= 0) {
+    buffer[n++] = c;
+  }
+  return n;
+}
+
+String Stream::readString() {
+  String s;
+  int c;
+
+  while((c = read()) >= 0) {
+    s += (char)c;
+  }
+  return s;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  int c;
+
+  while((c = read()) >= 0 && c != terminator) {
+    s += (char)c;
+  }
+  return s;
+}
+
+bool Stream::find(const char *target) {
+  return findUntil(target, NULL);
+}
+
+bool Stream::findUntil(const char *target, const char *terminator) {
+  size_t matched = 0;
+  size_t length = strlen(target);
+  int c;
+
+  if(length == 0) {
+    return true;
+  }
+  while((c = read()) >= 0) {
+    matched = (c == target[matched]) ? matched + 1 : ((c == target[0]) ? 1 : 0);
+    if(matched == length) {
+      return true;
+    }
+    if(terminator != NULL && *terminator && c == *terminator) {
+      return false;
+    }
+  }
+  return false;
+}
+
+size_t USBSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t USBSerial::write(const uint8_t *buffer, size_t size) {
+  _output.append((const char *)buffer, size);
+  if(_capture != NULL) {
+    fwrite(buffer, 1, size, _capture);
+  }
+  return size;
+}
+
+int USBSerial::read() {
+  int c;
+
+  if(_input.empty()) {
+    return -1;
+  }
+  c = (uint8_t)_input[0];
+  _input.erase(0, 1);
+  return c;
+}
+
+// Wire
+
+// A device already at the address is replaced, NULL takes it off the bus
+void TwoWire::attach(uint8_t address, SimI2cDevice *device) {
+  int i;
+
+  for(i = 0; i < _deviceCount; i++) {
+    if(_devices[i].address == address) {
+      _devices[i].device = device;
+      return;
+    }
+  }
+  if(_deviceCount < MAX_DEVICES) {
+    _devices[_deviceCount++] = {address, device};
+  }
+}
+
+SimI2cDevice *TwoWire::find(uint8_t address) {
+  int i;
+
+  for(i = 0; i < _deviceCount; i++) {
+    if(_devices[i].address == address) {
+      return _devices[i].device;
+    }
+  }
+  return NULL;
+}
+
+// Start, address byte, the data bytes (9 clocks each with the ACK) and stop
+void TwoWire::busTime(size_t bytes) {
+  Sim::advance((uint64_t)(2 + 9 * (bytes + 1)) * 1000000000 / _clock);
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _txAddress = address;
+  _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t c) {
+  if(_txLength >= sizeof(_tx)) {
+    return 0;
+  }
+  _tx[_txLength++] = c;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+
+  while(n < size && write(buffer[n])) {
+    n++;
+  }
+  return n;
+}
+
+// 0 is success, 2 an address NACK and 3 a data NACK, as on the device
+uint8_t TwoWire::endTransmission(uint8_t sendStop) {
+  SimI2cDevice *device = find(_txAddress);
+
+  _transactions++;
+  _bytes += _txLength;
+  busTime(_txLength);
+  if(device == NULL) {
+    return 2;
+  }
+  if(_txLength == 0) {
+    return 0; // a bus scan, the address alone is acknowledged
+  }
+  return device->write(_tx, _txLength) ? 0 : 3;
+}
+
+size_t TwoWire::requestFrom(uint8_t address, size_t quantity, uint8_t sendStop) {
+  SimI2cDevice *device = find(address);
+
+  _transactions++;
+  _rxLength = _rxPosition = 0;
+  if(quantity > sizeof(_rx)) {
+    quantity = sizeof(_rx);
+  }
+  if(device == NULL) {
+    busTime(0);
+    return 0;
+  }
+  _rxLength = device->read(_rx, quantity);
+  _bytes += _rxLength;
+  busTime(_rxLength);
+  return _rxLength;
+}
+
+// SPI
+
+SPIClass::SPIClass() {
+  spiBuses().push_back(this);
+}
+
+void SPIClass::attach(uint16_t csPin, SimSpiDevice *device) {
+  int i;
+
+  for(i = 0; i < _deviceCount; i++) {
+    if(_devices[i].csPin == csPin) {
+      _devices[i].device = device;
+      return;
+    }
+  }
+  if(_deviceCount < MAX_DEVICES) {
+    _devices[_deviceCount++] = {csPin, device};
+  }
+}
+
+void SPIClass::chipSelect(uint16_t pin, uint8_t value) {
+  int i;
+
+  for(i = 0; i < _deviceCount; i++) {
+    if(_devices[i].csPin == pin && value == HIGH && _devices[i].device != NULL) {
+      _devices[i].device->deselect();
+    }
+  }
+}
+
+// 333.3ns a byte at 24MHz adds up over a screen fill, so the fraction isn't dropped
+void SPIClass::busTime(size_t bytes) {
+  uint64_t scaled = (uint64_t)bytes * 8000000000ULL + _leftover;
+
+  _leftover = scaled % _clock;
+  Sim::advance(scaled / _clock);
+}
+
+// Chip select only counts once the driver has made the pin an output, pins start out low
+SimSpiDevice *SPIClass::selected() {
+  int i;
+
+  for(i = 0; i < _deviceCount; i++) {
+    if(_devices[i].device != NULL && Sim::mode(_devices[i].csPin) == OUTPUT && digitalRead(_devices[i].csPin) == LOW) {
+      return _devices[i].device;
+    }
+  }
+  return NULL;
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  SimSpiDevice *device = selected();
+
+  _bytes++;
+  busTime(1);
+  return (device == NULL) ? 0xFF : device->transfer(data);
+}
+
+void SPIClass::transfer(void *buffer, size_t length) {
+  transfer(buffer, buffer, length, NULL);
+}
+
+void SPIClass::transfer(const void *txBuffer, void *rxBuffer, size_t length, wiring_spi_dma_transfercomplete_callback_t callback) {
+  const uint8_t *tx = (const uint8_t *)txBuffer;
+  uint8_t *rx = (uint8_t *)rxBuffer;
+  SimSpiDevice *device = selected();
+  uint8_t in;
+  size_t i;
+
+  for(i = 0; i < length; i++) {
+    in = (device == NULL) ? 0xFF : device->transfer((tx == NULL) ? 0xFF : tx[i]);
+    if(rx != NULL) {
+      rx[i] = in;
+    }
+  }
+  _bytes += length;
+  busTime(length);
+  if(callback != NULL) {
+    callback();
+  }
+}
@@ -0,0 +1,472 @@
+#ifndef _PARTICLE_H_
+#define _PARTICLE_H_
+
+// Host (Linux) stand-in for the parts of Device OS this firmware uses, so src/ and lib/ build
+// unchanged with a desktop compiler. The hardware behind it is simulated:
+//  - time only moves when the code waits (delay(), bus transfers) or the runner says so, see Sim
+//  - Wire and SPI hand their bytes to register models of the sensors and the display
+//  - analogRead() returns whatever the test scripted for the pin
+// Only what the tree actually calls is here, with the Device OS signatures.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t pin_t;
+typedef uint32_t system_tick_t;
+typedef int32_t time32_t;
+
+#define ARDUINO 10800
+#define PARTICLE 1
+#define SPARK 1
+
+#define HIGH 1
+#define LOW 0
+
+enum PinMode {
+  INPUT,
+  OUTPUT,
+  INPUT_PULLUP,
+  INPUT_PULLDOWN
+};
+
+enum InterruptMode {
+  CHANGE,
+  RISING,
+  FALLING
+};
+
+enum BitOrder {
+  LSBFIRST = 0,
+  MSBFIRST = 1
+};
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+#define SPI_CLOCK_DIV2 0
+#define SPI_HAS_TRANSACTION 1
+
+#define HEX 16
+#define DEC 10
+#define OCT 8
+#define BIN 2
+
+// Pin numbers as on the Argon/Photon 2 header, A0..A5 are their own pins here
+enum {
+  D0, D1, D2, D3, D4, D5, D6, D7, D8, D9, D10, D11, D12, D13, D14, D15, D16, D17, D18, D19,
+  A0, A1, A2, A3, A4, A5, A6, A7,
+  TOTAL_PINS
+};
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define F(x) x
+class __FlashStringHelper;
+
+#define SYSTEM_MODE(mode)
+#define SYSTEM_THREAD(state)
+#define ATOMIC_BLOCK()
+#define SINGLE_THREADED_BLOCK()
+#define waitFor(condition, timeout) ((void)0)
+
+using std::min;
+using std::max;
+
+template <class T, class L, class H> T constrain(T value, L low, H high) {
+  return (value < (T)low) ? (T)low : ((value > (T)high) ? (T)high : value);
+}
+
+// Time and GPIO
+system_tick_t millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint16_t pin, PinMode mode);
+void digitalWrite(uint16_t pin, uint8_t value);
+int32_t digitalRead(uint16_t pin);
+int32_t analogRead(uint16_t pin);
+bool attachInterrupt(uint16_t pin, void (*handler)(), InterruptMode mode, int8_t priority = -1, uint8_t subpriority = 0);
+void detachInterrupt(uint16_t pin);
+void noInterrupts();
+void interrupts();
+int map(int value, int fromStart, int fromEnd, int toStart, int toEnd);
+double map(double value, double fromStart, double fromEnd, double toStart, double toEnd);
+
+class String {
+
+  std::string _s;
+
+  public:
+    String() {}
+    String(const char *s) : _s(s ? s : "") {}
+    String(const std::string &s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int value, int base = DEC);
+    String(unsigned int value, int base = DEC);
+    String(long value, int base = DEC);
+    String(unsigned long value, int base = DEC);
+    String(double value, int decimals = 2);
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    int toInt() const { return atoi(_s.c_str()); }
+    float toFloat() const { return atof(_s.c_str()); }
+    int indexOf(const char *s, unsigned int from = 0) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+    char charAt(unsigned int i) const { return (i < _s.length()) ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    String &operator+=(const String &s) { _s += s._s; return *this; }
+    String &operator+=(const char *s) { _s += s; return *this; }
+    String &operator+=(char c) { _s += c; return *this; }
+    String operator+(const String &s) const { return String(_s + s._s); }
+    String operator+(const char *s) const { return String(_s + s); }
+    bool operator==(const String &s) const { return _s == s._s; }
+    bool operator==(const char *s) const { return _s == s; }
+    bool operator!=(const char *s) const { return _s != s; }
+};
+
+inline String operator+(const char *a, const String &b) {
+  return String(a) + b;
+}
+
+class Print {
+
+  size_t printNumber(unsigned long value, int base);
+
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *s) { return (s == NULL) ? 0 : write((const uint8_t *)s, strlen(s)); }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(const __FlashStringHelper *s) { return write((const char *)s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int decimals = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <class T> size_t println(T value) { return print(value) + println(); }
+    template <class T> size_t println(T value, int format) { return print(value, format) + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t printlnf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t vprintf(bool newline, const char *format, va_list args);
+};
+
+class Stream : public Print {
+
+  protected:
+    unsigned long _timeout = 1000;
+
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    size_t readBytes(char *buffer, size_t length);
+    String readString();
+    String readStringUntil(char terminator);
+    bool find(const char *target);
+    bool findUntil(const char *target, const char *terminator);
+};
+
+// USB serial. What the firmware writes is kept for the test to look at (and optionally copied
+// to a file), what the test injects is what read() returns.
+class USBSerial : public Stream {
+
+  std::string _output;
+  std::string _input;
+  FILE *_capture = NULL;
+
+  public:
+    void begin(long = 9600) {}
+    void end() {}
+    bool isConnected() { return true; }
+    operator bool() { return true; }
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+    int available() { return _input.size(); }
+    int read();
+    int peek() { return _input.empty() ? -1 : (uint8_t)_input[0]; }
+
+    // Host only
+    void inject(const char *data, size_t size) { _input.append(data, size); }
+    void inject(const char *text) { inject(text, strlen(text)); }
+    const std::string &output() { return _output; }
+    void clearOutput() { _output.clear(); }
+    void captureTo(FILE *file) { _capture = file; }
+};
+extern USBSerial Serial;
+
+class SimI2cDevice;
+class SimSpiDevice;
+
+// I2C master. Each transaction goes to the model attached at its address, an address nobody
+// is attached to NACKs. The bus time (9 clocks a byte plus start/address/stop) passes in Sim.
+class TwoWire : public Stream {
+
+  static const int MAX_DEVICES = 8;
+
+  struct Attached {
+    uint8_t address;
+    SimI2cDevice *device;
+  };
+
+  Attached _devices[MAX_DEVICES];
+  int _deviceCount = 0;
+  uint32_t _clock = 100000;
+  uint8_t _txAddress = 0;
+  uint8_t _tx[32];
+  size_t _txLength = 0;
+  uint8_t _rx[32];
+  size_t _rxLength = 0;
+  size_t _rxPosition = 0;
+  uint32_t _transactions = 0;
+  uint32_t _bytes = 0;
+
+  SimI2cDevice *find(uint8_t address);
+  void busTime(size_t bytes);
+
+  public:
+    void begin() {}
+    void end() {}
+    bool isEnabled() { return true; }
+    void setClock(uint32_t speed) { _clock = speed; }
+    void setSpeed(uint32_t speed) { _clock = speed; }
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(uint8_t sendStop = true);
+    size_t requestFrom(uint8_t address, size_t quantity, uint8_t sendStop = true);
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+    int available() { return _rxLength - _rxPosition; }
+    int read() { return (_rxPosition < _rxLength) ? _rx[_rxPosition++] : -1; }
+    int peek() { return (_rxPosition < _rxLength) ? _rx[_rxPosition] : -1; }
+
+    // Host only. attach() replaces a device already at the address, NULL removes it. Every
+    // endTransmission() and requestFrom() counts as a transaction, so a register read
+    // (pointer write, then read) is two.
+    void attach(uint8_t address, SimI2cDevice *device);
+    uint32_t transactions() { return _transactions; }
+    uint32_t bytes() { return _bytes; }
+    void resetCounts() { _transactions = _bytes = 0; }
+};
+extern TwoWire Wire;
+
+class SPISettings {
+
+  public:
+    uint32_t clock = 16000000;
+    uint8_t bitOrder = MSBFIRST;
+    uint8_t dataMode = SPI_MODE0;
+
+    SPISettings() {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+};
+
+typedef void (*wiring_spi_dma_transfercomplete_callback_t)(void);
+
+// SPI master. Bytes go to the model whose chip select pin is low. DMA transfers are done by the
+// time transfer() returns (the bus time has passed) and call their callback right away.
+class SPIClass {
+
+  static const int MAX_DEVICES = 4;
+
+  struct Attached {
+    uint16_t csPin;
+    SimSpiDevice *device;
+  };
+
+  Attached _devices[MAX_DEVICES];
+  int _deviceCount = 0;
+  uint32_t _clock = 16000000;
+  uint32_t _bytes = 0;
+  uint64_t _leftover = 0; // bit time below a nanosecond, carried to the next transfer
+
+  SimSpiDevice *selected();
+  void busTime(size_t bytes);
+
+  public:
+    SPIClass();
+
+    void begin() {}
+    void begin(uint16_t) {}
+    void end() {}
+    void beginTransaction() {}
+    void beginTransaction(const SPISettings &settings) { _clock = settings.clock; }
+    void endTransaction() {}
+    void setBitOrder(uint8_t) {}
+    void setDataMode(uint8_t) {}
+    void setClockDivider(uint8_t) {}
+    unsigned setClockSpeed(unsigned value, unsigned scale = 1) { _clock = value * scale; return _clock; }
+    bool trylock() { return true; }
+    void lock() {}
+    void unlock() {}
+
+    uint8_t transfer(uint8_t data);
+    void transfer(void *buffer, size_t length);
+    void transfer(const void *txBuffer, void *rxBuffer, size_t length, wiring_spi_dma_transfercomplete_callback_t callback);
+    void transferCancel() {}
+
+    // Host only. attach() replaces a device already on csPin, NULL removes it.
+    void attach(uint16_t csPin, SimSpiDevice *device);
+    void chipSelect(uint16_t pin, uint8_t value);
+    uint32_t bytes() { return _bytes; }
+    uint32_t clock() { return _clock; }
+    void resetCounts() { _bytes = 0; }
+};
+extern SPIClass SPI;
+extern SPIClass SPI1;
+
+// Device OS software timer. The callbacks run from Sim as time passes, in the thread that
+// moved the clock, never nested inside each other.
+class Timer {
+
+  std::function<void(void)> _callback;
+  unsigned _period;
+  bool _oneShot;
+  bool _active;
+  uint64_t _due;
+
+  friend class Sim;
+
+  public:
+    Timer(unsigned period, void (*callback)(void), bool oneShot = false);
+    ~Timer();
+
+    bool start();
+    bool stop();
+    bool reset() { return start(); }
+    bool changePeriod(unsigned period);
+    bool isActive() { return _active; }
+};
+
+// Device OS system events, only the reset ones are ever raised here
+typedef uint64_t system_event_t;
+enum SystemEvents {
+  reset_pending = 1 << 3,
+  reset = 1 << 4
+};
+typedef void (*system_event_handler_t)(system_event_t event, int param);
+
+// reset() doesn't reset anything, it only tells the handlers registered for the reset event
+class SystemClass {
+
+  std::vector<std::pair<system_event_t, system_event_handler_t>> _handlers;
+
+  public:
+    uint32_t ticks() { return micros(); }
+    uint32_t ticksPerMicrosecond() { return 1; }
+    uint32_t freeMemory() { return 100000; }
+    bool on(system_event_t events, system_event_handler_t handler);
+    void reset();
+};
+extern SystemClass System;
+
+// Threads and queues from Device OS's concurrent HAL, on std::thread. These run for real
+// alongside the simulated clock: a worker thread that waits (delay()) sleeps in real time and
+// never moves Sim's clock, and a queue timeout is real milliseconds.
+typedef void *os_queue_t;
+typedef void os_thread_return_t;
+typedef os_thread_return_t (*os_thread_fn_t)(void *param);
+typedef uint8_t os_thread_prio_t;
+
+const os_thread_prio_t OS_THREAD_PRIORITY_DEFAULT = 2;
+const size_t OS_THREAD_STACK_SIZE_DEFAULT = 3 * 1024;
+const system_tick_t CONCURRENT_WAIT_FOREVER = (system_tick_t)-1;
+
+int os_queue_create(os_queue_t *queue, size_t item_size, size_t item_count, void *reserved);
+int os_queue_put(os_queue_t queue, const void *item, system_tick_t delay, void *reserved);
+int os_queue_take(os_queue_t queue, void *item, system_tick_t delay, void *reserved);
+int os_queue_destroy(os_queue_t queue, void *reserved);
+void os_thread_exit(void *reserved);
+
+class Thread {
+
+  struct Running;
+  Running *_running;
+
+  public:
+    Thread() : _running(NULL) {}
+    Thread(const char *name, os_thread_fn_t function, void *function_param = NULL,
+           os_thread_prio_t priority = OS_THREAD_PRIORITY_DEFAULT, size_t stack_size = OS_THREAD_STACK_SIZE_DEFAULT);
+    ~Thread();
+
+    bool isValid() { return _running != NULL; }
+    bool join();
+};
+
+// PRIVATE/NO_ACK are PublishFlags on Device OS, the stub only passes them through
+enum PublishFlag {
+  PUBLIC = 0,
+  PRIVATE = 1,
+  NO_ACK = 2,
+  WITH_ACK = 8
+};
+
+class CloudClass {
+
+  public:
+    void connect();
+    void disconnect();
+    bool connected();
+    void process() {}
+    bool publish(const char *event, const char *data, PublishFlag flag1 = PUBLIC, PublishFlag flag2 = PUBLIC);
+};
+extern CloudClass Particle;
+
+class TimeClass {
+
+  public:
+    time32_t now();
+    bool isValid();
+};
+extern TimeClass Time;
+
+// Nothing on the network answers, connect() always fails
+class TCPClient : public Stream {
+
+  public:
+    int connect(const char *, uint16_t) { return 0; }
+    int connect(uint8_t *, uint16_t) { return 0; }
+    bool connected() { return false; }
+    void stop() {}
+    size_t write(uint8_t) { return 1; }
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+};
+
+#include "Sim.h"
+
+#endif // _PARTICLE_H_
@@ -0,0 +1,20 @@
+#include "Particle.h"
+
+// Apart from the rest of the stub so programs that never run the firmware don't need
+// setup()/loop() to link
+
+static bool setupDone = false;
+
+void Sim::runFirmware(uint32_t ms, uint32_t loopOverheadMicros) {
+  uint64_t end;
+
+  if(!setupDone) {
+    setupDone = true;
+    setup();
+  }
+  end = _nanos + (uint64_t)ms * 1000000;
+  while(_nanos < end) {
+    loop();
+    advance((uint64_t)loopOverheadMicros * 1000);
+  }
+}
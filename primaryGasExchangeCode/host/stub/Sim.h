@@ -0,0 +1,72 @@
+#ifndef _SIM_H_
+#define _SIM_H_
+
+// Host only: the side of the stub that tests and the simulation runner drive. Included by the
+// stub Particle.h, firmware code never uses it.
+
+#include <vector>
+
+// A chip on the I2C bus, see TwoWire::attach(). write() gets every byte of one transaction
+// after the address (false NACKs it), read() fills a read transaction.
+class SimI2cDevice {
+
+  public:
+    virtual ~SimI2cDevice() {}
+    virtual bool write(const uint8_t *data, size_t length) = 0;
+    virtual size_t read(uint8_t *data, size_t length) = 0;
+};
+
+// A chip on an SPI bus, see SPIClass::attach(). transfer() is one byte each way while its chip
+// select is low, deselect() comes when it goes high again.
+class SimSpiDevice {
+
+  public:
+    virtual ~SimSpiDevice() {}
+    virtual uint8_t transfer(uint8_t out) = 0;
+    virtual void deselect() {}
+};
+
+struct SimEvent {
+  std::string name;
+  std::string data;
+  uint32_t millis;
+};
+
+// The simulated clock, pins and cloud. Time is in nanoseconds and only moves forward when
+// something waits: delay(), a bus transfer, or advance() from the runner between loop() calls.
+// Timer callbacks fire as the clock passes their due time.
+class Sim {
+
+  static uint64_t _nanos;
+  static bool _inTimer;
+
+  public:
+    static uint64_t nanos() { return _nanos; }
+    static void advance(uint64_t nanos);
+    static void advanceMillis(uint32_t ms) { advance((uint64_t)ms * 1000000); }
+
+    // Calls setup() once, then loop() until ms more have passed, the way Device OS would with
+    // loopOverheadMicros between passes
+    static void runFirmware(uint32_t ms, uint32_t loopOverheadMicros = 100);
+
+    // Drives an input pin from outside, firing an interrupt attached to the edge
+    static void setPin(uint16_t pin, uint8_t level);
+    static uint8_t pin(uint16_t pin);
+    static PinMode mode(uint16_t pin);
+    static void setAnalog(uint16_t pin, int32_t counts);
+    static void setAnalog(uint16_t pin, std::function<int32_t(void)> source);
+    static int32_t analogVolts(float volts) { return lroundf(constrain(volts, 0.0f, 3.3f) / 3.3f * 4095); }
+
+    // Cloud: whether connect() succeeds and whether publishes are accepted
+    static void setCloud(bool reachable, bool accepting = true);
+    static void setUnixTime(time32_t now);
+    static std::vector<SimEvent> &published();
+
+    // Back to power on, for tests that run several cases in one process
+    static void reset();
+};
+
+void setup();
+void loop();
+
+#endif // _SIM_H_
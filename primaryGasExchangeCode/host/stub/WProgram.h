@@ -0,0 +1 @@
+#include "Particle.h"
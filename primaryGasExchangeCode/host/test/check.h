@@ -0,0 +1,40 @@
+#ifndef _CHECK_H_
+#define _CHECK_H_
+
+// Just enough of a test framework for the host tests: CHECK() reports a failed condition with
+// its line and carries on, checkResult() is main()'s return value.
+
+#include <stdio.h>
+#include <math.h>
+
+static int checkFailures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if(!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      fflush(stdout); \
+      checkFailures++; \
+    } \
+  } while(0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+  do { \
+    double checkActual = (actual), checkExpected = (expected); \
+    if(!(fabs(checkActual - checkExpected) <= (tolerance))) { \
+      printf("%s:%d: %s is %g, expected %g +- %g\n", __FILE__, __LINE__, #actual, checkActual, checkExpected, (double)(tolerance)); \
+      fflush(stdout); \
+      checkFailures++; \
+    } \
+  } while(0)
+
+static inline int checkResult() {
+  if(checkFailures) {
+    printf("%d check(s) failed\n", checkFailures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
+
+#endif // _CHECK_H_
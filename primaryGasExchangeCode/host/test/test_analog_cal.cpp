@@ -0,0 +1,74 @@
+// AnalogCal's integer path swept over every window sum AnalogSampler can produce, against the
+// float formulas it replaced in getCO2()/getThermoTemp()
+
+#include "Particle.h"
+#include "check.h"
+#include "AnalogCal.h"
+
+const uint32_t MAX_SUM = (uint32_t)ADC_FULL_SCALE * ADC_WINDOW;
+
+// The old firmware: average counts, intoVolts() and the sensor line, in float
+static float floatCO2(uint32_t sum) {
+  float measuredVolts = (3.3 / 4095) * ((float)sum / ADC_WINDOW);
+
+  return 2000 * (measuredVolts / 5.0);
+}
+
+static float floatLeafTemp(uint32_t sum) {
+  float voltage = (3.3 / 4095) * ((float)sum / ADC_WINDOW);
+
+  return (voltage - 1.25) / 0.005;
+}
+
+// The same line in double, rounded to the nearest thousandth, what analogToMilli() aims for
+static int32_t exactMilli(double unitsPerVolt, double zeroVolts, uint32_t sum) {
+  return lround(((3.3 / 4095) * ((double)sum / ADC_WINDOW) - zeroVolts) * unitsPerVolt * 1000.0);
+}
+
+// Within a thousandth of the float result, off the correctly rounded value by at most one
+// step, and never going down as the input goes up
+static void sweep(const char *name, AnalogCal cal, float (*reference)(uint32_t), double unitsPerVolt, double zeroVolts) {
+  double worstFloat = 0, error;
+  int32_t milli, previous = INT32_MIN;
+  int32_t worstRounding = 0, rounding;
+  uint32_t sum, backwards = 0;
+
+  for(sum = 0; sum <= MAX_SUM; sum++) {
+    milli = analogToMilli(cal, sum);
+    error = fabs(milli / 1000.0 - reference(sum));
+    worstFloat = (error > worstFloat) ? error : worstFloat;
+    rounding = abs(milli - exactMilli(unitsPerVolt, zeroVolts, sum));
+    worstRounding = (rounding > worstRounding) ? rounding : worstRounding;
+    if(milli < previous) {
+      backwards++;
+    }
+    previous = milli;
+  }
+  printf("%s: worst %.4f from float, %d thousandths from exact\n", name, worstFloat, (int)worstRounding);
+  CHECK(worstFloat <= 0.001);
+  CHECK(worstRounding <= 1);
+  CHECK(backwards == 0);
+}
+
+// A trim of none changes nothing, a real one is the trimmed line
+static void testTrim() {
+  AnalogCal trimmed = analogTrim(CO2_CAL, 1.02, -1500);
+  uint32_t sum;
+
+  CHECK(analogTrim(CO2_CAL, 1.0, 0).gain == CO2_CAL.gain);
+  CHECK(analogTrim(LEAF_TEMP_CAL, 1.0, 0).offset == LEAF_TEMP_CAL.offset);
+  for(sum = 0; sum <= MAX_SUM; sum += 997) {
+    CHECK_NEAR(analogToMilli(trimmed, sum) / 1000.0, floatCO2(sum) * 1.02 - 1.5, 0.002);
+  }
+  trimmed = analogTrim(LEAF_TEMP_CAL, 0.98, 250);
+  for(sum = 0; sum <= MAX_SUM; sum += 997) {
+    CHECK_NEAR(analogToMilli(trimmed, sum) / 1000.0, floatLeafTemp(sum) * 0.98 + 0.25, 0.002);
+  }
+}
+
+int main() {
+  sweep("CO2", CO2_CAL, floatCO2, 2000.0 / 5.0, 0.0);
+  sweep("leaf temp", LEAF_TEMP_CAL, floatLeafTemp, 1.0 / 0.005, 1.25);
+  testTrim();
+  return checkResult();
+}
@@ -0,0 +1,44 @@
+// AnalogSampler on the simulated timer: a sum covers exactly the last ADC_WINDOW samples and
+// nothing is made up before the first window has filled
+
+#include "Particle.h"
+#include "check.h"
+#include "AnalogSampler.h"
+
+static void testWindow() {
+  AnalogSampler sampler;
+  int first, second;
+
+  Sim::setAnalog(A5, 1000);
+  Sim::setAnalog(A2, 3);
+  first = sampler.addChannel(A5);
+  second = sampler.addChannel(A2);
+  CHECK(first == 0 && second == 1);
+  CHECK(sampler.addChannel(A3) == -1);
+  sampler.begin();
+  CHECK(!sampler.ready());
+
+  // Half a window: the sum of what was taken, not scaled up
+  Sim::advanceMillis(ADC_WINDOW / 2);
+  CHECK(!sampler.ready());
+  CHECK(sampler.sum(first) == 1000u * (ADC_WINDOW / 2));
+  CHECK(sampler.sum(second) == 3u * (ADC_WINDOW / 2));
+
+  Sim::advanceMillis(ADC_WINDOW / 2);
+  CHECK(sampler.ready());
+  CHECK(sampler.sum(first) == 1000u * ADC_WINDOW);
+
+  // A step moves through the window a sample at a time, then the old value is gone
+  Sim::setAnalog(A5, 2000);
+  Sim::advanceMillis(10);
+  CHECK(sampler.sum(first) == 1000u * (ADC_WINDOW - 10) + 2000u * 10);
+  Sim::advanceMillis(ADC_WINDOW);
+  CHECK(sampler.sum(first) == 2000u * ADC_WINDOW);
+  CHECK(sampler.sum(second) == 3u * ADC_WINDOW);
+  CHECK(sampler.sum(2) == 0);
+}
+
+int main() {
+  testWindow();
+  return checkResult();
+}
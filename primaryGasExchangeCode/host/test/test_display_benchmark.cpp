@@ -0,0 +1,99 @@
+// DisplayBenchmark and the SPITFT_STATS counters on the HX8357 model. The stub SPI counts
+// every byte that really goes out, so statBytes has to match it test for test.
+
+#include "Particle.h"
+#include "check.h"
+#include "DisplayBenchmark.h"
+#include "Adafruit_HX8357.h"
+#include "Hx8357Model.h"
+
+static_assert(sizeof(((Adafruit_SPITFT *)0)->statBytes) == 4, "built with SPITFT_STATS");
+
+const uint32_t PANEL_PIXELS = 480 * 320;
+
+Hx8357Model model(D5);
+Adafruit_HX8357 tft(D4, D5, -1);
+
+void drawNothing(Adafruit_SPITFT *display) {}
+
+// Every standard test: the counters match the bus, and the time is at least what the bytes
+// take at the SPI clock
+static void testSuite() {
+  DisplayBenchmark bench(&tft);
+  bench_test_t test;
+  bench_result_t result;
+  uint32_t bytesBefore, spiBytes;
+  int i;
+
+  bench.addStandardSuite();
+  CHECK(bench.count() == 15);
+  for(i = 0; i < bench.count(); i++) {
+    test = *bench.test(i);
+    if(test.prepare) {
+      test.prepare(&tft);
+    }
+    test.prepare = NULL;
+    bytesBefore = SPI.bytes();
+    result = bench.measure(&test);
+    spiBytes = SPI.bytes() - bytesBefore;
+    if(result.bytes != spiBytes) {
+      printf("%s: statBytes %lu, SPI %lu\n", test.name, (unsigned long)result.bytes, (unsigned long)spiBytes);
+    }
+    CHECK(result.bytes == spiBytes);
+    CHECK(result.pixels > 0);
+    CHECK(result.micros + 1 >= (uint64_t)spiBytes * 8 * 1000000 / SPI.clock()); // micros() rounds down at both ends
+  }
+}
+
+// Five full screen fills, 2 bytes a pixel plus the address window commands
+static void testFillScreen() {
+  DisplayBenchmark bench(&tft);
+  bench_test_t test;
+  bench_result_t result;
+
+  bench.addStandardSuite();
+  test = *bench.test(0);
+  result = bench.measure(&test);
+  CHECK(result.pixels == 5 * PANEL_PIXELS);
+  CHECK(result.bytes >= 5 * PANEL_PIXELS * 2);
+  CHECK(result.bytes < 5 * PANEL_PIXELS * 2 + 5 * 16);
+}
+
+// Each fan of lines starts on a clear screen, like the original. The top left fan draws the
+// whole left edge, the bottom right one only every 6th pixel of it.
+static void testLineFans() {
+  DisplayBenchmark bench(&tft);
+
+  bench.addStandardSuite();
+  CHECK(strcmp(bench.test(2)->name, "Lines (top left)") == 0);
+  bench.measure(bench.test(2));
+  CHECK(model.pixel(0, 3) == 0x07FF);
+  CHECK(strcmp(bench.test(5)->name, "Lines (bottom right)") == 0);
+  bench.measure(bench.test(5));
+  CHECK(model.pixel(0, 3) == 0x0000);
+  CHECK(model.pixel(0, 6) == 0x07FF);
+  CHECK(model.pixel(tft.width() - 1, tft.height() - 1) == 0x07FF);
+}
+
+// An empty test costs nothing
+static void testEmpty() {
+  DisplayBenchmark bench(&tft);
+  bench_test_t test = {"Nothing", NULL, drawNothing};
+  bench_result_t result;
+
+  result = bench.measure(&test);
+  CHECK(result.pixels == 0);
+  CHECK(result.bytes == 0);
+  CHECK(result.micros == 0);
+}
+
+int main() {
+  SPI.attach(D4, &model);
+  tft.begin();
+  tft.setRotation(1);
+  testSuite();
+  testFillScreen();
+  testLineFans();
+  testEmpty();
+  return checkResult();
+}
@@ -0,0 +1,200 @@
+// The whole firmware on the simulated board: what it draws, what it streams and what the
+// touch panel does to the valves.
+
+#include "Particle.h"
+#include "check.h"
+#include "FirmwareBoard.h"
+#include "PngWriter.h"
+#include "SampleLog.h"
+#include "TaskScheduler.h"
+#include "Telemetry.h"
+#include "TimeSeries.h"
+#include "ValveSequencer.h"
+#include "Adafruit_HDC302x.h"
+#include "Adafruit_HX8357.h"
+
+extern ValveSequencer valves;
+extern SampleLog sampleLog;
+extern TaskScheduler scheduler;
+extern int hdcTaskId;
+
+// Every frame on Serial, COBS decoded with the CRC checked. A stretch between two 0x00s that
+// isn't a good frame, like printed text, comes back empty.
+static std::vector<std::string> frames() {
+  const std::string &out = Serial.output();
+  std::vector<std::string> result;
+  std::string raw;
+  size_t start = 0, end, i, code;
+  bool good;
+
+  while((end = out.find('\0', start)) != std::string::npos) {
+    raw.clear();
+    good = true;
+    // COBS: each code byte is one more than the data bytes before the next zero
+    for(i = start; i < end && good; i += code) {
+      code = (uint8_t)out[i];
+      good = (i + code <= end);
+      raw.append(out, i + 1, good ? code - 1 : 0);
+      if(code != 0xFF && i + code < end) {
+        raw.push_back(0);
+      }
+    }
+    good = good && raw.size() >= (size_t)TELEMETRY_HEADER_SIZE + 2 &&
+      Telemetry::crc16((const uint8_t *)raw.data(), raw.size() - 2) == (uint16_t)((uint8_t)raw[raw.size() - 2] | ((uint8_t)raw[raw.size() - 1] << 8));
+    result.push_back(good ? raw : std::string());
+    start = end + 1;
+  }
+  return result;
+}
+
+// The last frame of a type on Serial, empty if there's none
+static std::string lastFrame(uint8_t type) {
+  std::vector<std::string> all = frames();
+
+  for(auto frame = all.rbegin(); frame != all.rend(); frame++) {
+    if(!frame->empty() && (uint8_t)(*frame)[0] == type) {
+      return *frame;
+    }
+  }
+  return std::string();
+}
+
+// The last sample frame's values, in thousandths. False if there's none.
+static bool lastSample(int32_t *values, int *count) {
+  std::string frame = lastFrame(TELEMETRY_FRAME_SAMPLE);
+
+  if(frame.empty()) {
+    return false;
+  }
+  *count = (uint8_t)frame[7];
+  memcpy(values, frame.data() + TELEMETRY_HEADER_SIZE, *count * 4);
+  return true;
+}
+
+static void testScreen() {
+  GFXcanvas16 *screen = board.display.screen();
+
+  CHECK(screen->width() == 480 && screen->height() == 320);
+  CHECK(board.display.pixel(10, 10) == HX8357_GREEN);   // menu, top
+  CHECK(board.display.pixel(10, 300) == HX8357_RED);    // menu, bottom
+  CHECK(board.display.pixel(76, 100) == HX8357_WHITE);  // CO2 box outline
+  CHECK(board.display.pixel(300, 240) == HX8357_WHITE); // T/RH divider
+  CHECK(board.display.pixel(150, 130) == HX8357_BLACK);
+  CHECK(writePng("test_firmware.png", screen));
+}
+
+static void testTelemetry() {
+  int32_t values[TELEMETRY_MAX_CHANNELS];
+  int count = 0;
+
+  CHECK(lastSample(values, &count));
+  CHECK(count == 10);
+  CHECK_NEAR(values[0] / 1000.0, 420.0, 1.0);   // CO2
+  CHECK_NEAR(values[1] / 1000.0, 850.0, 5.0);   // lux
+  CHECK_NEAR(values[2] / 1000.0, 25.0, 0.2);    // leaf
+  CHECK_NEAR(values[3] / 1000.0, 21.5, 0.01);   // base T
+  CHECK_NEAR(values[4] / 1000.0, 40.0, 0.01);
+  CHECK_NEAR(values[5] / 1000.0, 24.0, 0.01);   // chamber T
+  CHECK_NEAR(values[6] / 1000.0, 62.0, 0.01);
+  CHECK(values[7] > 0);                         // lux ALS counts
+  CHECK(values[8] >= 0 && values[8] <= 3000);    // gain code
+  CHECK(values[9] >= 25000 && values[9] <= 800000); // integration time, ms
+
+  // Nothing but frames on the port, no text in between
+  for(const std::string &frame : frames()) {
+    CHECK(!frame.empty());
+  }
+
+  board.co2Volts = 1.5;
+  board.base.set(30.0, 20.0);
+  Sim::runFirmware(3000);
+  CHECK(lastSample(values, &count));
+  CHECK_NEAR(values[0] / 1000.0, 600.0, 1.0);
+  CHECK_NEAR(values[3] / 1000.0, 30.0, 0.01);
+}
+
+// Bottom of the menu starts the chamber cycle, top stops it
+static void testTouch() {
+  std::string phase;
+  std::vector<std::string> after;
+  size_t frameCount, i;
+
+  CHECK(valves.phase() == PHASE_IDLE);
+  tapDisplay(40, 240);
+  CHECK(valves.phase() == PHASE_PURGE);
+  phase = lastFrame(TELEMETRY_FRAME_PHASE);
+  CHECK(phase.size() == TELEMETRY_HEADER_SIZE + 3 + 2 && phase[8] == PHASE_PURGE);
+  CHECK(Sim::pin(D6) == HIGH && Sim::pin(D10) == HIGH && Sim::pin(D19) == HIGH);
+  Sim::runFirmware(61000);
+  CHECK(valves.phase() == PHASE_EQUILIBRATE);
+  CHECK(Sim::pin(D6) == LOW && Sim::pin(D19) == HIGH);
+  tapDisplay(40, 80);
+  CHECK(valves.phase() == PHASE_IDLE);
+  CHECK(Sim::pin(D6) == LOW && Sim::pin(D10) == LOW && Sim::pin(D19) == LOW);
+
+  // Held, the zones are the manual override: everything open or closed, no protocol running
+  tapDisplay(40, 240, 2500);
+  CHECK(!valves.running());
+  CHECK(Sim::pin(D6) == HIGH && Sim::pin(D10) == HIGH && Sim::pin(D19) == HIGH);
+  Sim::runFirmware(61000);
+  CHECK(Sim::pin(D6) == HIGH && Sim::pin(D10) == HIGH && Sim::pin(D19) == HIGH);
+  // Closing everything with nothing running isn't a phase change, nothing is reported
+  frameCount = frames().size();
+  tapDisplay(40, 80, 2500);
+  CHECK(!valves.running());
+  CHECK(Sim::pin(D6) == LOW && Sim::pin(D10) == LOW && Sim::pin(D19) == LOW);
+  after = frames();
+  for(i = frameCount; i < after.size(); i++) {
+    CHECK(after[i][0] == TELEMETRY_FRAME_SAMPLE);
+  }
+}
+
+// A full chamber cycle ends its measure phase with a flux frame over the 120s fit
+static void testFluxFrame() {
+  std::string frame;
+  int32_t fit[5];
+
+  tapDisplay(40, 240);
+  // The chamber HDC302x samples faster while measuring, and the readout task keeps up with it
+  Sim::runFirmware(95000);
+  CHECK(valves.phase() == PHASE_MEASURE);
+  CHECK(board.chamber.autoMode() == AUTO_MEASUREMENT_4MPS_LP0);
+  CHECK(board.base.autoMode() == AUTO_MEASUREMENT_1MPS_LP0);
+  CHECK(scheduler.getPeriod(hdcTaskId) == 250);
+  Sim::runFirmware(120000);
+  CHECK(valves.phase() == PHASE_VENT);
+  CHECK(board.chamber.autoMode() == AUTO_MEASUREMENT_1MPS_LP0);
+  CHECK(scheduler.getPeriod(hdcTaskId) == 1000);
+  frame = lastFrame(TELEMETRY_FRAME_FLUX);
+  CHECK(frame.size() == TELEMETRY_HEADER_SIZE + 5 * 4 + 2 && frame[7] == 5);
+  if(frame.size() == TELEMETRY_HEADER_SIZE + 5 * 4 + 2) {
+    memcpy(fit, frame.data() + TELEMETRY_HEADER_SIZE, sizeof(fit));
+    CHECK_NEAR(fit[0] / 1000.0, 0.0, 0.01);   // flat CO2, no flux
+    CHECK_NEAR(fit[3] / 1000.0, 120.0, 0.5);  // seconds
+    CHECK(fit[4] / 1000 >= 1000);             // samples, one a CO2 window
+  }
+  tapDisplay(40, 80);
+}
+
+// A planned reset waits for rows still queued for the sample log to reach flash
+static void testResetFlush() {
+  LogRecord record;
+
+  Sim::runFirmware(30000);
+  CHECK(sampleLog.next() > 0);
+  System.reset();
+  CHECK(sampleLog.written() == sampleLog.next());
+  CHECK(sampleLog.failed() == 0);
+  CHECK(sampleLog.read(sampleLog.next() - 1, &record) && record.count == SERIES_CHANNELS);
+}
+
+int main() {
+  attachBoard();
+  Sim::runFirmware(5000);
+  testScreen();
+  testTelemetry();
+  testTouch();
+  testFluxFrame();
+  testResetFlush();
+  return checkResult();
+}
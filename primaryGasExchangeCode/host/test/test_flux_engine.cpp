@@ -0,0 +1,114 @@
+// FluxEngine on synthetic chamber closures where the answer is known: a straight CO2 ramp, the
+// same ramp diluted by water vapour, and a flat CO2 that only looks like it moves because the
+// chamber gets wetter
+
+#include "Particle.h"
+#include "check.h"
+#include "FluxEngine.h"
+
+const float VOLUME = 0.0004;    // m^3, as in the firmware
+const float AREA = 0.0006;      // m^2
+const unsigned int WINDOW = 120000;
+
+// 0.5 ppm/s in 0.4 L over 6 cm^2 at 25C and standard pressure, dry:
+// 0.5 * 101325 * 0.0004 / (8.314 * 298.15) / 0.0006 umol m-2 s-1
+const double DRY_FLUX = 13.6254;
+// Same with the chamber at 60% RH, water fraction 0.018712 at closure
+const double WET_FLUX = 13.3705;
+
+// A dry ramp is the fit exactly: slope in ppm/s and flux in umol m-2 s-1
+static void testDryRamp() {
+  FluxEngine engine(VOLUME, AREA, WINDOW);
+  FluxResult result;
+  unsigned int t;
+
+  engine.begin(10000);
+  for(t = 0; t <= WINDOW; t += 1000) {
+    CHECK(engine.add(10000 + t, 400.0 + 0.5 * t / 1000.0, 25.0, 0.0));
+  }
+  CHECK(engine.result(&result));
+  CHECK(result.samples == 121);
+  CHECK_NEAR(result.seconds, 120.0, 1e-3);
+  CHECK_NEAR(result.slope, 0.5, 1e-4);
+  CHECK_NEAR(result.r2, 1.0, 1e-6);
+  CHECK_NEAR(result.flux, DRY_FLUX, 1e-3);
+  CHECK(engine.done(10000 + WINDOW));
+  CHECK(!engine.add(10000 + WINDOW + 1000, 500.0, 25.0, 0.0)); // past the window
+  CHECK(engine.result(&result));
+  CHECK(result.samples == 121);
+}
+
+// The analyzer sees the dry ramp diluted by C / (1 - W). Corrected, the slope is the dry one
+// again, and the flux only counts the dry air in the chamber.
+static void testDilution() {
+  FluxEngine engine(VOLUME, AREA, WINDOW);
+  FluxResult result;
+  float w = FluxEngine::waterFraction(25.0, 60.0, STANDARD_PRESSURE);
+  unsigned int t;
+
+  CHECK_NEAR(w, 0.018712, 1e-5);
+  engine.begin(0);
+  for(t = 0; t <= WINDOW; t += 1000) {
+    engine.add(t, (400.0 + 0.5 * t / 1000.0) * (1.0 - w), 25.0, 60.0);
+  }
+  CHECK(engine.result(&result));
+  CHECK_NEAR(result.slope, 0.5, 1e-3);
+  CHECK_NEAR(result.flux, WET_FLUX, 2e-2);
+}
+
+// Transpiration wets the chamber while dry CO2 stays at 400ppm. The raw reading falls, the
+// corrected one doesn't.
+static void testHumidityOnly() {
+  FluxEngine engine(VOLUME, AREA, WINDOW);
+  FluxResult result;
+  float rh, w;
+  unsigned int t;
+
+  engine.begin(0);
+  for(t = 0; t <= WINDOW; t += 1000) {
+    rh = 50.0 + 20.0 * t / WINDOW;
+    w = FluxEngine::waterFraction(25.0, rh, STANDARD_PRESSURE);
+    engine.add(t, 400.0 * (1.0 - w), 25.0, rh);
+  }
+  CHECK(engine.result(&result));
+  CHECK_NEAR(result.slope, 0.0, 1e-4);
+  CHECK_NEAR(result.flux, 0.0, 3e-3);
+}
+
+// Noise lowers r2 but leaves the slope, and the flux follows the pressure
+static void testNoiseAndPressure() {
+  FluxEngine engine(VOLUME, AREA, WINDOW);
+  FluxResult result;
+  unsigned int t;
+
+  engine.setPressure(80.0);
+  engine.begin(0);
+  for(t = 0; t <= WINDOW; t += 1000) {
+    engine.add(t, 400.0 + 0.5 * t / 1000.0 + ((t / 1000) % 2 ? 2.0 : -2.0), 25.0, 0.0);
+  }
+  CHECK(engine.result(&result));
+  CHECK_NEAR(result.slope, 0.5, 2e-3);
+  CHECK(result.r2 < 0.99 && result.r2 > 0.9);
+  CHECK_NEAR(result.flux, DRY_FLUX * 80.0 / STANDARD_PRESSURE, 0.1);
+}
+
+// Two samples are no fit
+static void testTooFew() {
+  FluxEngine engine(VOLUME, AREA, WINDOW);
+  FluxResult result;
+
+  engine.begin(0);
+  engine.add(0, 400.0, 25.0, 0.0);
+  engine.add(1000, 401.0, 25.0, 0.0);
+  CHECK(!engine.result(&result));
+  CHECK(result.samples == 2 && result.flux == 0);
+}
+
+int main() {
+  testDryRamp();
+  testDilution();
+  testHumidityOnly();
+  testNoiseAndPressure();
+  testTooFew();
+  return checkResult();
+}
@@ -0,0 +1,143 @@
+// The driver probes (InstrumentationHooks.h) against what actually went over the simulated
+// buses. Built with INSTRUMENTATION, see CMakeLists.txt.
+
+#include "Particle.h"
+#include "check.h"
+#include "Instrumentation.h"
+#include "Adafruit_HDC302x.h"
+#include "Adafruit_VEML7700.h"
+#include "Adafruit_TSC2007.h"
+#include "Adafruit_HX8357.h"
+#include "Hdc302xModel.h"
+#include "Veml7700Model.h"
+#include "Tsc2007Model.h"
+#include "Hx8357Model.h"
+
+// Collects what the dumps print
+class Capture : public Print {
+
+  public:
+    std::string text;
+
+    size_t write(uint8_t c) { text.push_back(c); return 1; }
+    using Print::write;
+};
+
+static void resetAll() {
+  Instrumentation::reset();
+  Wire.resetCounts();
+  SPI.resetCounts();
+}
+
+// Every I2C byte goes through Adafruit_I2CDevice or the VEML7700's own copy of it, and each
+// of their reads and writes is one Wire transaction
+static void testI2c() {
+  Hdc302xModel hdcModel(23.5, 51.0);
+  Veml7700Model vemlModel(400.0);
+  Adafruit_HDC302x hdc;
+  Adafruit_VEML7700_ veml;
+  double temperature, humidity;
+
+  Wire.attach(0x44, &hdcModel);
+  Wire.attach(0x10, &vemlModel);
+  CHECK(hdc.begin(0x44));
+  CHECK(veml.begin());
+  hdc.setAutoMode(AUTO_MEASUREMENT_1MPS_LP0);
+
+  resetAll();
+  CHECK(hdc.readAutoTempRH(temperature, humidity));
+  CHECK(Wire.bytes() > 0);
+  CHECK(Instrumentation::stats(INSTR_I2C)->bytes == Wire.bytes());
+  CHECK(Instrumentation::stats(INSTR_I2C)->count == Wire.transactions());
+
+  resetAll();
+  CHECK_NEAR(veml.readLux(), 400.0, 0.1);
+  CHECK(Wire.transactions() == 2);
+  CHECK(Instrumentation::stats(INSTR_I2C)->bytes == Wire.bytes());
+  CHECK(Instrumentation::stats(INSTR_I2C)->count == 2);
+
+  resetAll();
+  veml.setGain(VEML7700_GAIN_2);
+  CHECK(Instrumentation::stats(INSTR_I2C)->bytes == 3);
+  CHECK(Instrumentation::stats(INSTR_I2C)->count == 1);
+  Wire.attach(0x44, NULL);
+  Wire.attach(0x10, NULL);
+}
+
+// The drivers' waits on the part show up as blocked time
+static void testBlocked() {
+  Hdc302xModel hdcModel(23.5, 51.0);
+  Tsc2007Model tscModel(D3);
+  Adafruit_HDC302x hdc;
+  Adafruit_TSC2007 tsc;
+  double temperature, humidity;
+  uint16_t x, y, z1, z2;
+
+  Wire.attach(0x44, &hdcModel);
+  Wire.attach(0x48, &tscModel);
+  CHECK(hdc.begin(0x44));
+  CHECK(tsc.begin(0x48));
+
+  resetAll();
+  CHECK(hdc.readTemperatureHumidityOnDemand(temperature, humidity, TRIGGERMODE_LP0));
+  CHECK(Instrumentation::stats(INSTR_BLOCKED)->count == 1);
+  CHECK(Instrumentation::stats(INSTR_BLOCKED)->totalMicros >= 1000);
+
+  resetAll();
+  tscModel.press(1234, 2345, 500);
+  CHECK(tsc.read_touch(&x, &y, &z1, &z2));
+  CHECK(Instrumentation::stats(INSTR_BLOCKED)->count >= 1);
+  CHECK(Instrumentation::stats(INSTR_BLOCKED)->totalMicros >= 500);
+  Wire.attach(0x44, NULL);
+  Wire.attach(0x48, NULL);
+}
+
+// Adafruit_SPITFT writes the bus itself, not through Adafruit_SPIDevice. All of its bytes
+// still count as SPI, and as TFT inside the startWrite()..endWrite() that sent them.
+static void testTft() {
+  Hx8357Model model(D5);
+  Adafruit_HX8357 tft(D4, D5, -1);
+
+  SPI.attach(D4, &model);
+  tft.begin();
+  tft.setRotation(1);
+
+  resetAll();
+  tft.fillScreen(HX8357_BLACK);
+  CHECK(SPI.bytes() >= 480 * 320 * 2);
+  CHECK(Instrumentation::stats(INSTR_SPI)->bytes == SPI.bytes());
+  CHECK(Instrumentation::stats(INSTR_TFT)->bytes == SPI.bytes());
+  CHECK(Instrumentation::stats(INSTR_TFT)->count == 1);
+  CHECK(Instrumentation::stats(INSTR_TFT)->depth == 0);
+
+  resetAll();
+  tft.drawPixel(3, 5, HX8357_RED);
+  tft.fillRect(20, 30, 40, 10, HX8357_GREEN);
+  CHECK(Instrumentation::stats(INSTR_SPI)->bytes == SPI.bytes());
+  CHECK(Instrumentation::stats(INSTR_TFT)->bytes == SPI.bytes());
+  CHECK(Instrumentation::stats(INSTR_TFT)->count == 2);
+}
+
+// Commands come in on one stream, the dumps go out on another, never onto the command port
+static void testPoll() {
+  Capture out;
+  size_t before;
+
+  Instrumentation::reset();
+  Instrumentation::record(INSTR_HDC, 100, 2500, 12);
+  before = Serial.output().size();
+  Serial.inject("sr", 2);
+  Instrumentation::poll(&Serial, &out);
+  CHECK(Serial.output().size() == before);
+  CHECK(out.text.find("phase,count,total_us,max_us,p99_us,bytes,bytes_per_s\n") != std::string::npos);
+  CHECK(out.text.find("\nhdc,1,2500,2500,2500,12,") != std::string::npos);
+  CHECK(out.text.find("start_us,phase,us,bytes\n100,hdc,2500,12\n") != std::string::npos);
+}
+
+int main() {
+  testI2c();
+  testBlocked();
+  testTft();
+  testPoll();
+  return checkResult();
+}
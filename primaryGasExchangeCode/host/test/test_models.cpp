@@ -0,0 +1,122 @@
+// The vendored drivers against the register models: what the firmware reads back has to be
+// what the model was told, or nothing built on the simulation means anything.
+
+#include "Particle.h"
+#include "check.h"
+#include "Adafruit_HDC302x.h"
+#include "Adafruit_VEML7700.h"
+#include "Adafruit_TSC2007.h"
+#include "Adafruit_MAX31856.h"
+#include "Adafruit_HX8357.h"
+#include "Hdc302xModel.h"
+#include "Veml7700Model.h"
+#include "Tsc2007Model.h"
+#include "Max31856Model.h"
+#include "Hx8357Model.h"
+#include "PngWriter.h"
+
+static void testHdc302x() {
+  Hdc302xModel model(23.5, 51.0);
+  Adafruit_HDC302x hdc;
+  double temperature, humidity;
+
+  Wire.attach(0x44, &model);
+  CHECK(hdc.begin(0x44));
+  CHECK(!hdc.readAutoTempRH(temperature, humidity)); // NACKs until auto mode is on
+  hdc.setAutoMode(AUTO_MEASUREMENT_1MPS_LP0);
+  CHECK(model.autoMode() != 0);
+  CHECK(hdc.readAutoTempRH(temperature, humidity));
+  CHECK_NEAR(temperature, 23.5, 0.01);
+  CHECK_NEAR(humidity, 51.0, 0.01);
+  model.set(-10.25, 88.0);
+  CHECK(hdc.readAutoTempRH(temperature, humidity));
+  CHECK_NEAR(temperature, -10.25, 0.01);
+  CHECK_NEAR(humidity, 88.0, 0.01);
+  CHECK(!Adafruit_HDC302x().begin(0x45)); // nothing there
+}
+
+static void testVeml7700() {
+  Veml7700Model model(500.0);
+  Adafruit_VEML7700_ veml;
+
+  Wire.attach(0x10, &model);
+  CHECK(veml.begin());
+  veml.setGain(VEML7700_GAIN_1);
+  veml.setIntegrationTime(VEML7700_IT_100MS);
+  CHECK_NEAR(model.counts(), 500.0 / 0.0576, 1);
+  CHECK_NEAR(veml.readLux(), 500.0, 0.1);
+  veml.setGain(VEML7700_GAIN_1_8);
+  veml.setIntegrationTime(VEML7700_IT_25MS);
+  CHECK_NEAR(veml.readLux(), 500.0, 500.0 * 0.05);
+  model.setLux(100000.0);
+  veml.setGain(VEML7700_GAIN_2);
+  veml.setIntegrationTime(VEML7700_IT_800MS);
+  CHECK(model.counts() == 65535); // saturated, like the part
+}
+
+static void testTsc2007() {
+  Tsc2007Model model(D3);
+  Adafruit_TSC2007 tsc;
+  uint16_t x, y, z1, z2;
+
+  Wire.attach(0x48, &model);
+  CHECK(tsc.begin(0x48));
+  CHECK(Sim::pin(D3) == HIGH);
+  model.press(1234, 2345, 500);
+  CHECK(Sim::pin(D3) == LOW);
+  CHECK(tsc.read_touch(&x, &y, &z1, &z2));
+  CHECK(x == 1234 && y == 2345 && z1 == 500);
+  model.release();
+  CHECK(Sim::pin(D3) == HIGH);
+}
+
+static void testMax31856() {
+  Max31856Model model(152.25, 23.5);
+  Adafruit_MAX31856 max(D8);
+
+  SPI1.attach(D8, &model);
+  CHECK(max.begin());
+  max.setThermocoupleType(MAX31856_TCTYPE_K);
+  CHECK(max.getThermocoupleType() == MAX31856_TCTYPE_K);
+  CHECK_NEAR(max.readThermocoupleTemperature(), 152.25, 0.0078125);
+  CHECK_NEAR(max.readCJTemperature(), 23.5, 0.015625);
+  model.setTemperatures(-40.5, -5.0);
+  CHECK_NEAR(max.readThermocoupleTemperature(), -40.5, 0.0078125);
+  CHECK_NEAR(max.readCJTemperature(), -5.0, 0.015625);
+  CHECK(model.conversions() >= 2);
+  model.setFault(MAX31856_FAULT_OPEN);
+  CHECK(max.readFault() == MAX31856_FAULT_OPEN);
+}
+
+// A pixel, a rectangle and text land where GFX drew them in every rotation
+static void testHx8357() {
+  Hx8357Model model(D5);
+  Adafruit_HX8357 tft(D4, D5, -1);
+  int rotation;
+
+  SPI.attach(D4, &model);
+  tft.begin();
+  for(rotation = 0; rotation < 4; rotation++) {
+    tft.setRotation(rotation);
+    tft.fillScreen(HX8357_BLACK);
+    tft.drawPixel(3, 5, HX8357_RED);
+    tft.fillRect(20, 30, 40, 10, HX8357_GREEN);
+    CHECK(model.screen()->width() == tft.width());
+    CHECK(model.pixel(3, 5) == HX8357_RED);
+    CHECK(model.pixel(4, 5) == HX8357_BLACK);
+    CHECK(model.pixel(20, 30) == HX8357_GREEN);
+    CHECK(model.pixel(59, 39) == HX8357_GREEN);
+    CHECK(model.pixel(60, 39) == HX8357_BLACK);
+    CHECK(model.pixel(tft.width() - 1, tft.height() - 1) == HX8357_BLACK);
+  }
+  CHECK(writePng("test_models.png", model.screen()));
+}
+
+int main() {
+  testHdc302x();
+  testVeml7700();
+  testTsc2007();
+  testMax31856();
+  testHx8357();
+  return checkResult();
+}
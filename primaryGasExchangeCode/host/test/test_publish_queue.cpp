@@ -0,0 +1,191 @@
+// PublishQueue against a mock publish_fn_t: batching by size and by age, buffering while
+// offline, backoff on failures up to the cap, and draining a backlog once the cloud is back
+
+#include "Particle.h"
+#include "check.h"
+#include "PublishQueue.h"
+#include <algorithm>
+
+const unsigned int MAX_AGE = 60000;
+const uint32_t UNIX_START = 1700000000;
+
+static bool accepting = true;
+static int attempts = 0;
+static std::vector<std::string> sent;
+
+static bool mockPublish(const char *event, const char *data) {
+  attempts++;
+  if(!accepting || strcmp(event, "gasExchange") != 0) {
+    return false;
+  }
+  sent.push_back(data);
+  return true;
+}
+
+static void resetMock() {
+  accepting = true;
+  attempts = 0;
+  sent.clear();
+}
+
+static void row(float *values, float base) {
+  int i;
+
+  for(i = 0; i < PUBLISH_CHANNELS; i++) {
+    values[i] = base + i;
+  }
+}
+
+static int rowsIn(const std::string &data) {
+  return std::count(data.begin(), data.end(), ';') + 1;
+}
+
+// A few rows wait for maxAge, then go as one event in the documented format
+static void testAge() {
+  PublishQueue queue("gasExchange", mockPublish, MAX_AGE);
+  float values[PUBLISH_CHANNELS];
+  uint32_t now;
+
+  resetMock();
+  queue.setDecimals(0, 1);
+  for(now = 0; now < 30000; now += 10000) {
+    row(values, now / 10000);
+    queue.add(now, values);
+  }
+  values[2] = NAN;
+  queue.add(30000, values);
+  CHECK(!queue.update(true, 30000, UNIX_START + 30));
+  CHECK(!queue.update(true, MAX_AGE - 1, UNIX_START + 59));
+  CHECK(attempts == 0);
+  CHECK(queue.update(true, MAX_AGE, UNIX_START + 60));
+  CHECK(sent.size() == 1 && queue.count() == 0);
+  CHECK(sent[0] == "1700000000,0,1,2,3,4,5,6;10,10,2,3,4,5,6,7;10,20,3,4,5,6,7,8;10,20,3,,5,6,7,8");
+  CHECK(!queue.update(true, MAX_AGE + 1000, UNIX_START + 61));
+}
+
+// A batch goes as soon as it fills an event, without waiting for maxAge, and the next one
+// not before PUBLISH_MIN_INTERVAL
+static void testSize() {
+  PublishQueue queue("gasExchange", mockPublish, MAX_AGE);
+  float values[PUBLISH_CHANNELS];
+  uint32_t now;
+  int added = 0;
+
+  resetMock();
+  for(now = 0; queue.update(true, now, UNIX_START + now / 1000) == false && added < 100; now += 100) {
+    row(values, 1000000 + added);
+    queue.add(now, values);
+    added++;
+  }
+  CHECK(sent.size() == 1);
+  CHECK(now < MAX_AGE);
+  CHECK(sent[0].size() <= (size_t)PUBLISH_MAX_DATA);
+  CHECK(rowsIn(sent[0]) == added - 1);
+  CHECK(queue.count() == 1);
+  CHECK(queue.backoff() == PUBLISH_MIN_INTERVAL);
+}
+
+// Offline nothing is tried and rows pile up, dropping the oldest once full
+static void testOffline() {
+  PublishQueue queue("gasExchange", mockPublish, MAX_AGE);
+  float values[PUBLISH_CHANNELS];
+  uint32_t now;
+  int i;
+
+  resetMock();
+  for(i = 0; i < PUBLISH_QUEUE_ROWS + 10; i++) {
+    now = i * 10000;
+    row(values, i);
+    queue.add(now, values);
+    CHECK(!queue.update(false, now, 0));
+  }
+  CHECK(attempts == 0);
+  CHECK(queue.count() == PUBLISH_QUEUE_ROWS);
+  CHECK(queue.dropped() == 10);
+
+  // Back online, the oldest kept row (number 10) goes first and the backlog drains at the rate
+  // limit
+  now += 1000;
+  CHECK(queue.update(true, now, UNIX_START));
+  CHECK(sent[0].find(",10,11,12,13,14,15,16;") != std::string::npos);
+  CHECK(!queue.update(true, now + PUBLISH_MIN_INTERVAL - 1, UNIX_START));
+  while(queue.count() > 0 && sent.size() < 100) {
+    now += PUBLISH_MIN_INTERVAL;
+    queue.update(true, now, UNIX_START);
+  }
+  CHECK(queue.count() == 0);
+  CHECK(attempts == (int)sent.size());
+}
+
+// Failures double the wait from 2s to the 5 minute cap, nothing is tried in between, and the
+// first success drops it back to the rate limit with nothing lost
+static void testBackoff() {
+  PublishQueue queue("gasExchange", mockPublish, MAX_AGE);
+  float values[PUBLISH_CHANNELS];
+  unsigned int expected = 2 * PUBLISH_MIN_INTERVAL;
+  uint32_t now = MAX_AGE;
+  int failures = 0;
+
+  resetMock();
+  row(values, 1);
+  queue.add(0, values);
+  accepting = false;
+  while(failures < 12) {
+    CHECK(!queue.update(true, now, UNIX_START));
+    CHECK(attempts == failures + 1);
+    CHECK(queue.backoff() == expected);
+    failures++;
+    CHECK(!queue.update(true, now + queue.backoff() - 1, UNIX_START));
+    CHECK(attempts == failures);
+    now += queue.backoff();
+    expected = (2 * expected > PUBLISH_MAX_BACKOFF) ? PUBLISH_MAX_BACKOFF : 2 * expected;
+  }
+  CHECK(queue.backoff() == PUBLISH_MAX_BACKOFF);
+  CHECK(queue.count() == 1);
+
+  accepting = true;
+  CHECK(queue.update(true, now, UNIX_START));
+  CHECK(sent.size() == 1 && queue.count() == 0);
+  CHECK(queue.backoff() == PUBLISH_MIN_INTERVAL);
+}
+
+// Rows restored from flash after a reset keep their own wall clock time and go out before the
+// rows taken since, and published() moves past the last row the cloud accepted
+static void testRestore() {
+  PublishQueue queue("gasExchange", mockPublish, MAX_AGE);
+  float values[PUBLISH_CHANNELS];
+  uint32_t now = 5000;
+
+  resetMock();
+  CHECK(queue.published() == 0);
+  row(values, 1);
+  queue.restore(UNIX_START - 3600, values, 40);
+  row(values, 2);
+  queue.restore(UNIX_START - 3590, values, 41);
+  row(values, 3);
+  queue.add(now, values, 42);
+  CHECK(queue.count() == 3);
+
+  // The restored rows are an hour old, so the batch goes without waiting for maxAge
+  CHECK(queue.update(true, now, UNIX_START));
+  CHECK(sent.size() == 1);
+  CHECK(sent[0] == "1699996400,1,2,3,4,5,6,7;10,2,3,4,5,6,7,8;3590,3,4,5,6,7,8,9");
+  CHECK(queue.published() == 43);
+
+  // Live rows after that are timed by millis() again
+  row(values, 4);
+  queue.add(now + 10000, values, 43);
+  CHECK(!queue.update(true, now + 10000, UNIX_START + 10));
+  CHECK(queue.update(true, now + 10000 + MAX_AGE, UNIX_START + 10 + MAX_AGE / 1000));
+  CHECK(sent.size() == 2 && sent[1] == "1700000010,4,5,6,7,8,9,10");
+  CHECK(queue.published() == 44);
+}
+
+int main() {
+  testAge();
+  testSize();
+  testOffline();
+  testBackoff();
+  testRestore();
+  return checkResult();
+}
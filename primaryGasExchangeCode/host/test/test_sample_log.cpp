@@ -0,0 +1,347 @@
+// SampleLog on the host file system: rows round trip through the writer thread, which writes
+// whole pages, the segment ring drops whole segments and keeps files small, and begin() finds
+// where the last run stopped after a torn write or a bad record at the start of the newest
+// segment
+
+#include "Particle.h"
+#include "check.h"
+#include "SampleLog.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+
+static std::string segmentFile(const char *path, uint32_t file) {
+  return std::string(path) + "." + std::to_string(file);
+}
+
+static void removeLog(const char *path) {
+  uint32_t file;
+
+  for(file = 0; file < LOG_SEGMENTS; file++) {
+    unlink(segmentFile(path, file).c_str());
+  }
+}
+
+static off_t fileSize(const std::string &path) {
+  struct stat info;
+
+  return (stat(path.c_str(), &info) == 0) ? info.st_size : -1;
+}
+
+static void row(float *values, uint32_t n) {
+  values[0] = n;
+  values[1] = -0.5f * n;
+  values[2] = NAN;
+}
+
+// Appends rows until next() is count, flushing whenever the writer's queue is full
+static void fill(SampleLog &log, uint32_t count) {
+  float values[3];
+
+  while(log.next() < count) {
+    row(values, log.next());
+    if(!log.append(1700000000 + log.next(), log.next() * 10, values, 3)) {
+      CHECK(log.flush());
+    }
+  }
+  CHECK(log.flush());
+}
+
+static bool holds(SampleLog &log, uint32_t sequence) {
+  LogRecord record;
+
+  return log.read(sequence, &record) && record.sequence == sequence && record.count == 3 &&
+         record.millis == sequence * 10 && record.values[0] == (int32_t)sequence * 1000 &&
+         record.values[1] == -(int32_t)sequence * 500 && record.values[2] == INT32_MIN;
+}
+
+static void corrupt(const std::string &path, uint32_t index) {
+  FILE *f = fopen(path.c_str(), "r+b");
+  uint8_t byte;
+
+  CHECK(f != NULL);
+  fseek(f, index * LOG_RECORD_SIZE + 12, SEEK_SET);
+  fread(&byte, 1, 1, f);
+  byte ^= 0x01;
+  fseek(f, index * LOG_RECORD_SIZE + 12, SEEK_SET);
+  fwrite(&byte, 1, 1, f);
+  fclose(f);
+}
+
+// Written rows read back, in this run and the next
+static void testRoundTrip() {
+  const char *path = "test_sample_log_round";
+  uint32_t i;
+
+  removeLog(path);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    CHECK(log.next() == 0 && log.oldest() == 0);
+    fill(log, 20);
+    CHECK(log.written() == 20 && log.failed() == 0);
+    for(i = 0; i < 20; i++) {
+      CHECK(holds(log, i));
+    }
+    CHECK(!log.read(20, NULL));
+  }
+  SampleLog log(path);
+
+  CHECK(log.begin());
+  CHECK(log.next() == 20 && log.written() == 20);
+  CHECK(holds(log, 0) && holds(log, 19));
+  fill(log, 25);
+  CHECK(holds(log, 24));
+  CHECK(fileSize(segmentFile(path, 0)) == 25 * LOG_RECORD_SIZE);
+  removeLog(path);
+}
+
+// Coming round the ring unlinks the oldest segment's file and starts it again, no file ever
+// holds more than a segment
+static void testWrap() {
+  const char *path = "test_sample_log_wrap";
+  const uint32_t count = LOG_SEGMENTS * LOG_SEGMENT_RECORDS + 100;
+  uint32_t file;
+
+  removeLog(path);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    fill(log, count);
+    CHECK(log.oldest() == LOG_SEGMENT_RECORDS);
+    CHECK(!holds(log, LOG_SEGMENT_RECORDS - 1));
+    CHECK(holds(log, LOG_SEGMENT_RECORDS));
+    CHECK(holds(log, count - 1));
+    CHECK(fileSize(segmentFile(path, 0)) == 100 * LOG_RECORD_SIZE);
+    for(file = 1; file < LOG_SEGMENTS; file++) {
+      CHECK(fileSize(segmentFile(path, file)) == LOG_SEGMENT_RECORDS * LOG_RECORD_SIZE);
+    }
+  }
+  SampleLog log(path);
+
+  CHECK(log.begin());
+  CHECK(log.next() == count);
+  CHECK(holds(log, LOG_SEGMENT_RECORDS) && holds(log, count - 1));
+  removeLog(path);
+}
+
+// A reset in the middle of a write leaves part of a record at the end of the file. It counts
+// as never written and the next row replaces it.
+static void testTornTail() {
+  const char *path = "test_sample_log_torn";
+  std::string file = segmentFile(path, 0);
+
+  removeLog(path);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    fill(log, 6);
+  }
+  CHECK(truncate(file.c_str(), 5 * LOG_RECORD_SIZE + 20) == 0);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    CHECK(log.next() == 5);
+    CHECK(holds(log, 4) && !holds(log, 5));
+    fill(log, 7);
+    CHECK(holds(log, 5) && holds(log, 6));
+    CHECK(fileSize(file) == 7 * LOG_RECORD_SIZE);
+  }
+  // A bad CRC at the end is the same
+  corrupt(file, 6);
+  SampleLog log(path);
+
+  CHECK(log.begin());
+  CHECK(log.next() == 6);
+  removeLog(path);
+}
+
+// A bad first record in the newest segment doesn't lose the segment: begin() scans on to
+// the next good one and still resumes after the last
+static void testBadFirstRecord() {
+  const char *path = "test_sample_log_first";
+  const uint32_t count = LOG_SEGMENT_RECORDS + 3;
+
+  removeLog(path);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    fill(log, count);
+  }
+  corrupt(segmentFile(path, 1), 0);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    CHECK(log.next() == count);
+    CHECK(!holds(log, LOG_SEGMENT_RECORDS) && holds(log, count - 1));
+  }
+  // With the whole newest segment bad, the one before is the newest
+  corrupt(segmentFile(path, 1), 1);
+  corrupt(segmentFile(path, 1), 2);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    CHECK(log.next() == LOG_SEGMENT_RECORDS);
+    fill(log, LOG_SEGMENT_RECORDS + 700);
+  }
+  // Bad at both ends, the bisection still lands on the last good record
+  corrupt(segmentFile(path, 1), 0);
+  corrupt(segmentFile(path, 1), 699);
+  SampleLog log(path);
+
+  CHECK(log.begin());
+  CHECK(log.next() == LOG_SEGMENT_RECORDS + 699);
+  CHECK(holds(log, LOG_SEGMENT_RECORDS + 698));
+  removeLog(path);
+}
+
+// Waits for the writer thread, in real time
+static bool writtenBy(SampleLog &log, uint32_t written) {
+  int i;
+
+  for(i = 0; i < 200 && log.written() < written; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return log.written() == written;
+}
+
+// Rows go to flash a whole page at a time, a partial page only when flushed. A failed write
+// doesn't count as written.
+static void testPages() {
+  const char *path = "test_sample_log_pages";
+  std::string file = segmentFile(path, 0);
+  float values[3];
+  uint32_t i;
+
+  removeLog(path);
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    for(i = 0; i < LOG_PAGE_RECORDS + 3; i++) {
+      row(values, i);
+      CHECK(log.append(0, i * 10, values, 3));
+    }
+    CHECK(writtenBy(log, LOG_PAGE_RECORDS));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(log.written() == LOG_PAGE_RECORDS);
+    CHECK(fileSize(file) == LOG_PAGE_RECORDS * LOG_RECORD_SIZE);
+    CHECK(log.flush());
+    CHECK(fileSize(file) == (LOG_PAGE_RECORDS + 3) * LOG_RECORD_SIZE);
+    // The rest of the page follows on from the flushed part
+    fill(log, 2 * LOG_PAGE_RECORDS);
+    CHECK(fileSize(file) == 2 * LOG_PAGE_RECORDS * LOG_RECORD_SIZE);
+    CHECK(holds(log, 2 * LOG_PAGE_RECORDS - 1));
+  }
+  removeLog(path);
+
+  // A directory where the segment file should be: the write fails and nothing is written
+  SampleLog log(path);
+
+  CHECK(log.begin());
+  unlink(file.c_str());
+  CHECK(mkdir(file.c_str(), 0777) == 0);
+  for(i = 0; i < 3; i++) {
+    row(values, i);
+    CHECK(log.append(0, i * 10, values, 3));
+  }
+  CHECK(!log.flush());
+  CHECK(log.written() == 0);
+  CHECK(log.failed() == 3);
+  CHECK(!holds(log, 0));
+  log.end();
+  rmdir(file.c_str());
+  removeLog(path);
+}
+
+// append() never waits for flash. Rows the queue has no room for are counted and don't use
+// up a sequence number, so what's kept has no gaps.
+static void testDropped() {
+  const char *path = "test_sample_log_dropped";
+  SampleLog log(path);
+  float values[3];
+  uint32_t i;
+
+  removeLog(path);
+  CHECK(log.begin());
+  for(i = 0; i < 500; i++) {
+    row(values, log.next());
+    log.append(1700000000 + log.next(), log.next() * 10, values, 3);
+  }
+  CHECK(log.next() + log.dropped() == 500);
+  CHECK(log.flush());
+  CHECK(log.written() == log.next());
+  for(i = 0; i < log.next(); i++) {
+    CHECK(holds(log, i));
+  }
+  log.end();
+  removeLog(path);
+}
+
+// The mark is written behind the records and is back after a restart. A damaged mark file
+// reads as 0.
+static void testMark() {
+  const char *path = "test_sample_log_mark";
+  std::string file = std::string(path) + ".mark";
+
+  removeLog(path);
+  unlink(file.c_str());
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    CHECK(log.marked() == 0);
+    fill(log, 10);
+    log.mark(7);
+    log.mark(9);
+    CHECK(log.marked() == 9);
+    CHECK(log.flush());
+  }
+  {
+    SampleLog log(path);
+
+    CHECK(log.begin());
+    CHECK(log.marked() == 9);
+    CHECK(log.next() == 10);
+  }
+  FILE *f = fopen(file.c_str(), "r+b");
+  CHECK(f != NULL);
+  fputc(0x55, f);
+  fclose(f);
+  SampleLog log(path);
+
+  CHECK(log.begin());
+  CHECK(log.marked() == 0);
+  removeLog(path);
+  unlink(file.c_str());
+}
+
+// Nowhere to write: begin() says so and rows are turned away
+static void testUnavailable() {
+  SampleLog log("no/such/directory/samples.log");
+  float values[3] = {1, 2, 3};
+
+  CHECK(!log.begin());
+  CHECK(!log.append(0, 0, values, 3));
+  CHECK(!log.flush());
+}
+
+int main() {
+  testRoundTrip();
+  testWrap();
+  testTornTail();
+  testBadFirstRecord();
+  testPages();
+  testDropped();
+  testMark();
+  testUnavailable();
+  return checkResult();
+}
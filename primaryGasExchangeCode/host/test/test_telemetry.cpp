@@ -0,0 +1,207 @@
+// Telemetry's encoder against the golden frames in telemetry_frames.txt, which
+// test_telemetry_decode.py runs through tools/telemetry_decode.py. A change to the frame format
+// has to change both, run with --write to regenerate the file from the encoder.
+
+#include "Particle.h"
+#include "check.h"
+#include "Telemetry.h"
+#include <map>
+
+// Collects what Telemetry writes
+class Capture : public Print {
+
+  public:
+    std::string bytes;
+
+    size_t write(uint8_t c) { bytes.push_back(c); return 1; }
+    using Print::write;
+};
+
+static std::string hex(const std::string &bytes) {
+  static const char digits[] = "0123456789abcdef";
+  std::string out;
+
+  for(uint8_t c : bytes) {
+    out.push_back(digits[c >> 4]);
+    out.push_back(digits[c & 0x0F]);
+  }
+  return out;
+}
+
+static std::string cobsDecode(const std::string &in) {
+  std::string out;
+  size_t i, code;
+
+  for(i = 0; i < in.size(); i += code) {
+    code = (uint8_t)in[i];
+    if(code == 0 || i + code > in.size()) {
+      return "<bad>";
+    }
+    out.append(in, i + 1, code - 1);
+    if(code != 0xFF && i + code < in.size()) {
+      out.push_back(0);
+    }
+  }
+  return out;
+}
+
+// The golden frames, one send each, in sequence order
+static std::vector<std::pair<std::string, std::string>> goldenFrames() {
+  std::vector<std::pair<std::string, std::string>> frames;
+  Capture port;
+  Telemetry telemetry(&port);
+  const float sample[] = {412.5, 850.0, 25.03, NAN, -40.25, 0.0, 62.0, 1234.0, 2.0, 100.0};
+  const float zeros[] = {0, 0, 0};
+  const float flux[] = {13.625, 0.5, 0.9987, 120.0, 121.0};
+
+  telemetry.send(123456, sample, 10);
+  frames.push_back({"sample", port.bytes});
+  port.bytes.clear();
+  telemetry.sendPhase(200000, 3, 2);
+  frames.push_back({"phase", port.bytes});
+  port.bytes.clear();
+  telemetry.sendFlux(320000, flux, 5);
+  frames.push_back({"flux", port.bytes});
+  port.bytes.clear();
+  telemetry.sendText(330000, "Sample log unavailable");
+  frames.push_back({"text", port.bytes});
+  port.bytes.clear();
+  telemetry.send(0, zeros, 3);
+  frames.push_back({"zeros", port.bytes});
+  return frames;
+}
+
+static void testGolden(const char *path, bool write) {
+  std::vector<std::pair<std::string, std::string>> frames = goldenFrames();
+  std::map<std::string, std::string> golden;
+  char name[32], value[512];
+  FILE *f;
+
+  if(write) {
+    f = fopen(path, "w");
+    CHECK(f != NULL);
+    fprintf(f, "# Encoded telemetry frames with their 0x00 delimiter, written by test_telemetry --write\n");
+    for(auto &frame : frames) {
+      fprintf(f, "%s %s\n", frame.first.c_str(), hex(frame.second).c_str());
+    }
+    fclose(f);
+    return;
+  }
+  f = fopen(path, "r");
+  CHECK(f != NULL);
+  if(f == NULL) {
+    return;
+  }
+  while(fscanf(f, "%31s %511s", name, value) == 2) {
+    if(name[0] != '#') {
+      golden[name] = value;
+    }
+    else {
+      fscanf(f, "%*[^\n]");
+    }
+  }
+  fclose(f);
+  for(auto &frame : frames) {
+    if(golden[frame.first] != hex(frame.second)) {
+      printf("%s: %s\n  expected %s\n", frame.first.c_str(), hex(frame.second).c_str(), golden[frame.first].c_str());
+    }
+    CHECK(golden[frame.first] == hex(frame.second));
+  }
+}
+
+// What the golden frames hold, checked on the decoded bytes rather than trusted from the file
+static void testContents() {
+  std::vector<std::pair<std::string, std::string>> frames = goldenFrames();
+  std::string raw;
+  int32_t value;
+  uint16_t i;
+
+  for(i = 0; i < frames.size(); i++) {
+    const std::string &frame = frames[i].second;
+
+    CHECK(frame.back() == 0);
+    CHECK(frame.find('\0') == frame.size() - 1);
+    raw = cobsDecode(frame.substr(0, frame.size() - 1));
+    CHECK(raw.size() >= (size_t)TELEMETRY_HEADER_SIZE + 2);
+    CHECK(Telemetry::crc16((const uint8_t *)raw.data(), raw.size() - 2) == (uint16_t)((uint8_t)raw[raw.size() - 2] | ((uint8_t)raw[raw.size() - 1] << 8)));
+    CHECK(((uint8_t)raw[1] | ((uint8_t)raw[2] << 8)) == i);
+  }
+
+  raw = cobsDecode(frames[0].second.substr(0, frames[0].second.size() - 1));
+  CHECK(raw[0] == TELEMETRY_FRAME_SAMPLE && raw[7] == 10);
+  memcpy(&value, raw.data() + TELEMETRY_HEADER_SIZE + 3 * 4, 4);
+  CHECK(value == INT32_MIN); // NaN
+  memcpy(&value, raw.data() + TELEMETRY_HEADER_SIZE + 4 * 4, 4);
+  CHECK(value == -40250);
+
+  raw = cobsDecode(frames[1].second.substr(0, frames[1].second.size() - 1));
+  CHECK(raw[0] == TELEMETRY_FRAME_PHASE && raw[7] == 3 && raw[8] == 3 && raw[9] == 2 && raw[10] == 0);
+  raw = cobsDecode(frames[3].second.substr(0, frames[3].second.size() - 1));
+  CHECK(raw[0] == TELEMETRY_FRAME_TEXT && raw.substr(8, raw.size() - 10) == "Sample log unavailable");
+}
+
+// The CRC's check value, and COBS round trips across the 254 byte block boundary with zeros
+// anywhere
+static void testCrcAndCobs() {
+  uint8_t in[700], out[700 + 700 / 254 + 2];
+  size_t length, encoded;
+  uint32_t seed = 1;
+  size_t i;
+
+  CHECK(Telemetry::crc16((const uint8_t *)"123456789", 9) == 0x29B1);
+  for(length = 0; length < sizeof(in); length += (length < 260) ? 1 : 37) {
+    for(i = 0; i < length; i++) {
+      seed = seed * 1103515245 + 12345;
+      in[i] = (seed >> 16) % 8 == 0 ? 0 : (seed >> 8);
+    }
+    encoded = Telemetry::cobsEncode(in, length, out);
+    CHECK(encoded <= length + length / 254 + 1);
+    CHECK(memchr(out, 0, encoded) == NULL);
+    CHECK(cobsDecode(std::string((const char *)out, encoded)) == std::string((const char *)in, length));
+  }
+}
+
+// TelemetryText: a frame per line, long lines in pieces, nothing but frames on the port
+static void testTextPrint() {
+  Capture port;
+  Telemetry telemetry(&port);
+  TelemetryText text(&telemetry);
+  std::vector<std::string> lines;
+  std::string raw;
+  size_t start = 0, end;
+
+  text.printf("phase,count\r\n");
+  text.print("loop,");
+  text.println(12);
+  for(end = 0; end < (size_t)TELEMETRY_MAX_TEXT + 10; end++) {
+    text.print('x');
+  }
+  text.print("\n\n");
+  while((end = port.bytes.find('\0', start)) != std::string::npos) {
+    raw = cobsDecode(port.bytes.substr(start, end - start));
+    CHECK(raw[0] == TELEMETRY_FRAME_TEXT);
+    lines.push_back(raw.substr(TELEMETRY_HEADER_SIZE, raw.size() - TELEMETRY_HEADER_SIZE - 2));
+    start = end + 1;
+  }
+  CHECK(start == port.bytes.size());
+  CHECK(lines.size() == 4);
+  if(lines.size() == 4) {
+    CHECK(lines[0] == "phase,count");
+    CHECK(lines[1] == "loop,12");
+    CHECK(lines[2] == std::string(TELEMETRY_MAX_TEXT, 'x'));
+    CHECK(lines[3] == "xxxxxxxxxx");
+  }
+}
+
+int main(int argc, char **argv) {
+  bool write = (argc > 1 && strcmp(argv[1], "--write") == 0);
+
+  testGolden(TELEMETRY_FRAMES, write);
+  if(write) {
+    return 0;
+  }
+  testContents();
+  testCrcAndCobs();
+  testTextPrint();
+  return checkResult();
+}
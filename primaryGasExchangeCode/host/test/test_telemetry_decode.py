@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""tools/telemetry_decode.py against the golden frames test_telemetry checks the firmware's
+encoder against: each frame type, CRC and COBS damage, NaN channels, text between frames and
+sequence gaps, the last two through the command line the way a capture is decoded."""
+
+import os
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TOOL = os.path.join(HERE, "..", "..", "tools", "telemetry_decode.py")
+sys.path.insert(0, os.path.dirname(TOOL))
+import telemetry_decode as decode  # noqa: E402
+
+failures = 0
+
+
+def check(condition, what):
+    global failures
+    if not condition:
+        failures += 1
+        print("FAILED: %s" % what)
+
+
+def near(a, b, tolerance=1e-9):
+    return a is not None and abs(a - b) <= tolerance
+
+
+def golden():
+    frames = {}
+    with open(os.path.join(HERE, "telemetry_frames.txt")) as f:
+        for line in f:
+            if line.strip() and not line.startswith("#"):
+                name, value = line.split()
+                frames[name] = bytes.fromhex(value)
+    return frames
+
+
+def body(frame):
+    """The encoded frame without its 0x00 delimiter, what parse() takes."""
+    return frame[:-1]
+
+
+def test_types(frames):
+    kind, sequence, ms, values = decode.parse(body(frames["sample"]))
+    check(kind == decode.FRAME_SAMPLE and sequence == 0 and ms == 123456, "sample header")
+    check(len(values) == 10 and len(decode.CHANNELS) == 10, "sample has every channel")
+    check(near(values[0], 412.5) and near(values[1], 850.0) and near(values[2], 25.03), "sample values")
+    check(values[3] is None, "NaN channel is missing")
+    check(near(values[4], -40.25) and values[5] == 0.0, "negative and zero")
+    check(near(values[7], 1234.0) and near(values[8], 2.0) and near(values[9], 100.0), "lux ALS, gain, IT")
+
+    kind, sequence, ms, phase = decode.parse(body(frames["phase"]))
+    check(kind == decode.FRAME_PHASE and sequence == 1 and ms == 200000, "phase header")
+    check(phase == (3, 2) and decode.PHASES[phase[0]] == "measure", "phase body")
+    check("valves measure (cycle 2)" in decode.describe((kind, sequence, ms, phase)), "phase text")
+
+    kind, sequence, ms, fit = decode.parse(body(frames["flux"]))
+    check(kind == decode.FRAME_FLUX and sequence == 2, "flux header")
+    check(near(fit[0], 13.625) and near(fit[1], 0.5) and near(fit[2], 0.999, 1e-3), "flux values")
+    check(fit[3] == 120.0 and fit[4] == 121.0, "flux span and samples")
+
+    kind, sequence, ms, text = decode.parse(body(frames["text"]))
+    check(kind == decode.FRAME_TEXT and sequence == 3, "text header")
+    check(text == "Sample log unavailable", "text body")
+
+    kind, sequence, ms, values = decode.parse(body(frames["zeros"]))
+    check(sequence == 4 and ms == 0 and values == [0.0, 0.0, 0.0], "zero run frame")
+
+
+# Any single damaged byte is rejected, by the CRC or by the COBS structure
+def test_damage(frames):
+    for name, frame in frames.items():
+        raw = body(frame)
+        rejected = 0
+        for i in range(len(raw)):
+            for flip in (0x01, 0x80):
+                damaged = bytearray(raw)
+                damaged[i] ^= flip
+                if damaged[i] != 0 and decode.parse(bytes(damaged)) is None:
+                    rejected += 1
+                elif damaged[i] == 0:
+                    rejected += 1  # a zero would end the frame early, the reader splits there
+        check(rejected == 2 * len(raw), "%s: every damaged byte rejected" % name)
+        check(decode.parse(raw[:-1]) is None, "%s: truncated frame rejected" % name)
+
+
+# COBS against the block boundary, with zeros anywhere
+def test_cobs():
+    for data in (b"", b"\x00", b"\x00\x00", bytes(range(1, 256)) * 2, bytes(range(256)) * 3):
+        encoded = bytearray()
+        code_at, run = 0, 1
+        encoded.append(0)
+        for byte in data:
+            if byte:
+                encoded.append(byte)
+                run += 1
+            if byte == 0 or run == 0xFF:
+                encoded[code_at] = run
+                code_at, run = len(encoded), 1
+                encoded.append(0)
+        encoded[code_at] = run
+        check(decode.cobs_decode(bytes(encoded)) == data, "COBS round trip of %d bytes" % len(data))
+
+
+# A capture as it comes off the port: text between frames, a lost frame, CSV out
+def test_capture(frames):
+    capture = (b"booting\n" + frames["sample"] + frames["phase"] + b"stray text\n" + frames["flux"] +
+               frames["zeros"])  # text (3) never arrived
+    result = subprocess.run([sys.executable, TOOL], input=capture, stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE, check=True)
+    out = result.stdout.decode().splitlines()
+    err = result.stderr.decode()
+    check(out[0].startswith("sequence,ms,co2_ppm,lux,") and out[0].endswith("lux_als,lux_gain,lux_it_ms"),
+          "CSV header")
+    check(out[1] == "0,123456,412.500,850.000,25.030,,-40.250,0.000,62.000,1234.000,2.000,100.000", "CSV row")
+    check(out[2] == "4,0,0.000,0.000,0.000", "second CSV row")
+    check(len(out) == 3, "only samples on stdout")
+    check("booting" in err and "stray text" in err, "text passed through")
+    check("valves measure" in err and "flux 13.625" in err, "phase and flux frames on stderr")
+    check("1 frames lost" in err, "sequence gap counted")
+
+
+def main():
+    frames = golden()
+    test_types(frames)
+    test_damage(frames)
+    test_cobs()
+    test_capture(frames)
+    print("%d check(s) failed" % failures if failures else "all checks passed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,75 @@
+// VEML7700 driver against the register model
+
+#include "Particle.h"
+#include "check.h"
+#include "Adafruit_VEML7700.h"
+#include "Veml7700Model.h"
+
+// Each field only touches its own bits of ALS_CONF
+static void testFieldMasks() {
+  Veml7700Model model;
+  Adafruit_VEML7700_ veml;
+
+  Wire.attach(0x10, &model);
+  CHECK(veml.begin());
+  veml.setIntegrationTime(VEML7700_IT_200MS);
+  veml.setPersistence(VEML7700_PERS_8);
+  CHECK(veml.getIntegrationTime() == VEML7700_IT_200MS);
+  CHECK(((model.config() >> 6) & 0x0F) == VEML7700_IT_200MS);
+  CHECK(((model.config() >> 4) & 0x03) == VEML7700_PERS_8);
+
+  veml.setGain(VEML7700_GAIN_1_4);
+  CHECK(veml.getGain() == VEML7700_GAIN_1_4);
+  CHECK(veml.getIntegrationTime() == VEML7700_IT_200MS);
+
+  veml.interruptEnable(true);
+  CHECK(veml.interruptEnabled());
+  CHECK(veml.enabled());
+  CHECK((model.config() & 0x01) == 0);
+  CHECK(veml.getPersistence() == VEML7700_PERS_8);
+}
+
+// The shadowed ALS_CONF: readLux() is one register read (two Wire transactions), config
+// setters one write, getters none
+static void testTransactions() {
+  Veml7700Model model(400.0);
+  Adafruit_VEML7700_ veml;
+
+  Wire.attach(0x10, &model);
+  CHECK(veml.begin());
+  veml.setGain(VEML7700_GAIN_1);
+  veml.setIntegrationTime(VEML7700_IT_100MS);
+
+  Wire.resetCounts();
+  CHECK_NEAR(veml.readLux(), 400.0, 0.1);
+  CHECK(Wire.transactions() == 2);
+  CHECK(model.dataReads() >= 1);
+
+  Wire.resetCounts();
+  veml.readWhite();
+  CHECK(Wire.transactions() == 2);
+
+  Wire.resetCounts();
+  CHECK(veml.getGain() == VEML7700_GAIN_1);
+  CHECK(veml.getIntegrationTime() == VEML7700_IT_100MS);
+  CHECK(veml.enabled());
+  CHECK(Wire.transactions() == 0);
+
+  Wire.resetCounts();
+  veml.setGain(VEML7700_GAIN_2);
+  CHECK(Wire.transactions() == 1);
+  CHECK(Wire.bytes() == 3); // command code and the 16-bit value
+  CHECK((model.config() >> 11) == VEML7700_GAIN_2);
+
+  // The data register isn't shadowed, every read goes to the part
+  Wire.resetCounts();
+  veml.readALS();
+  veml.readALS();
+  CHECK(Wire.transactions() == 4);
+}
+
+int main() {
+  testFieldMasks();
+  testTransactions();
+  return checkResult();
+}
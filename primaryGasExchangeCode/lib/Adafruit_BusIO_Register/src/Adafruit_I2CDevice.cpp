@@ -1,4 +1,5 @@
 #include "Adafruit_I2CDevice.h"
+#include "InstrumentationHooks.h"
 
 //#define DEBUG_SERIAL Serial
 
@@ -95,6 +96,7 @@ bool Adafruit_I2CDevice::detected(void) {
 bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
                                const uint8_t *prefix_buffer,
                                size_t prefix_len) {
+  INSTR_HOOK_SPAN(INSTR_HOOK_I2C, len + prefix_len);
   if ((len + prefix_len) > maxBufferSize()) {
     // currently not guaranteed to work if more than 32 bytes!
     // we will need to find out if some platforms have larger
@@ -174,6 +176,7 @@ bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
  *    @return True if read was successful, otherwise false.
  */
 bool Adafruit_I2CDevice::read(uint8_t *buffer, size_t len, bool stop) {
+  INSTR_HOOK_SPAN(INSTR_HOOK_I2C, len);
   size_t pos = 0;
   while (pos < len) {
     size_t read_len =
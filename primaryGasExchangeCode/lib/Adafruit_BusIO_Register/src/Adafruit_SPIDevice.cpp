@@ -1,4 +1,5 @@
 #include "Adafruit_SPIDevice.h"
+#include "InstrumentationHooks.h"
 
 #if !defined(SPI_INTERFACES_COUNT) ||                                          \
     (defined(SPI_INTERFACES_COUNT) && (SPI_INTERFACES_COUNT > 0))
@@ -122,6 +123,7 @@ bool Adafruit_SPIDevice::begin(void) {
  *    @param  len    The number of bytes to transfer
  */
 void Adafruit_SPIDevice::transfer(uint8_t *buffer, size_t len) {
+  INSTR_HOOK_SPAN(INSTR_HOOK_SPI, len);
   if (_spi) {
     // hardware SPI is easy
 
@@ -236,6 +236,9 @@ public:
 protected:
   void charBounds(unsigned char c, int16_t *x, int16_t *y, int16_t *minx,
                   int16_t *miny, int16_t *maxx, int16_t *maxy);
+  virtual bool writeGlyph(int16_t x, int16_t y, const uint8_t *glyph,
+                          uint16_t color, uint16_t bg, uint8_t size_x,
+                          uint8_t size_y);
   int16_t WIDTH;        ///< This is the 'raw' display width - never changes
   int16_t HEIGHT;       ///< This is the 'raw' display height - never changes
   int16_t _width;       ///< Display width as modified by current rotation
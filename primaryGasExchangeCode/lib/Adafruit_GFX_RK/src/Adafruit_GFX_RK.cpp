@@ -1146,9 +1146,21 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
     if (!_cp437 && (c >= 176))
       c++; // Handle 'classic' charset behavior
 
+    uint8_t glyph[5];
+    for (int8_t i = 0; i < 5; i++)
+      glyph[i] = pgm_read_byte(&font[c * 5 + i]);
+
     startWrite();
+    // An opaque glyph that is fully onscreen is a plain rectangle of
+    // pixels, so a display that can stream a block gets it all at once.
+    if ((bg != color) && (x >= 0) && (y >= 0) &&
+        (x + 6 * size_x <= _width) && (y + 8 * size_y <= _height) &&
+        writeGlyph(x, y, glyph, color, bg, size_x, size_y)) {
+      endWrite();
+      return;
+    }
     for (int8_t i = 0; i < 5; i++) { // Char bitmap = 5 columns
-      uint8_t line = pgm_read_byte(&font[c * 5 + i]);
+      uint8_t line = glyph[i];
       for (int8_t j = 0; j < 8; j++, line >>= 1) {
         if (line & 1) {
           if (size_x == 1 && size_y == 1)
@@ -1233,6 +1245,36 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
 
   } // End classic vs custom font
 }
+/**************************************************************************/
+/*!
+   @brief   Push a whole opaque 'classic' glyph in one go. Called by
+   drawChar() inside a startWrite() transaction, only when the background is
+   opaque and the 6x8 cell (scaled) is entirely onscreen. The default has no
+   block transfer and returns false, so drawChar() falls back to drawing the
+   glyph one font pixel at a time.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    glyph  The 5 column bytes of the character, LSB at the top
+    @param    color 16-bit 5-6-5 Color to draw the character with
+    @param    bg 16-bit 5-6-5 Color to fill the background with
+    @param    size_x  Font magnification level in X-axis
+    @param    size_y  Font magnification level in Y-axis
+    @returns  True if the glyph was drawn
+*/
+/**************************************************************************/
+bool Adafruit_GFX::writeGlyph(int16_t x, int16_t y, const uint8_t *glyph,
+                              uint16_t color, uint16_t bg, uint8_t size_x,
+                              uint8_t size_y) {
+  (void)x;
+  (void)y;
+  (void)glyph;
+  (void)color;
+  (void)bg;
+  (void)size_x;
+  (void)size_y;
+  return false;
+}
+
 /**************************************************************************/
 /*!
     @brief  Print one byte/character of data, used to support print()
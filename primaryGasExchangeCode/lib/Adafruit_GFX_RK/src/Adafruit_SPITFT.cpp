@@ -35,6 +35,7 @@
 #if !defined(__AVR_ATtiny85__) && !defined(__AVR_ATtiny84__)
 
 #include "Adafruit_SPITFT.h"
+#include "InstrumentationHooks.h"
 
 #if defined(__AVR__)
 #if defined(__AVR_XMEGA__) // only tested with __AVR_ATmega4809__
@@ -64,6 +65,35 @@
 static volatile bool dma_busy = false;
 static void dma_callback(Adafruit_ZeroDMA *dma) { dma_busy = false; }
 
+#endif
+
+#if defined(SPITFT_STATS)
+#define STAT_PIXELS(n) (statPixels += (n)) ///< Count pixels written
+#define STAT_BYTES(n) (statBytes += (n))   ///< Count bytes sent on hard SPI
+#else
+#define STAT_PIXELS(n) ///< Compiled out
+#define STAT_BYTES(n)  ///< Compiled out
+#endif
+
+/*!
+    @brief  Every hardware SPI write goes through here: the SPITFT_STATS
+            counter, the SPI byte count and the open startWrite() span for
+            the instrumentation probes.
+*/
+#define SPI_BYTES(n)                                                           \
+  do {                                                                         \
+    STAT_BYTES(n);                                                            \
+    INSTR_HOOK_BYTES(INSTR_HOOK_SPI, n);                                       \
+    INSTR_HOOK_BYTES(INSTR_HOOK_TFT, n);                                       \
+  } while (0)
+
+#if defined(USE_PARTICLE_SPI_DMA)
+// DMA transfer-in-progress indicator and SPI.transfer() completion callback
+static volatile bool dma_busy = false;
+static void dma_callback(void) { dma_busy = false; }
+#endif
+
+#if defined(USE_SPI_DMA) && (defined(__SAMD51__) || defined(ARDUINO_SAMD_ZERO))
 #if defined(__SAMD51__)
 // Timer/counter info by index #
 static const struct {
@@ -889,6 +919,32 @@ void Adafruit_SPITFT::initSPI(uint32_t freq, uint8_t spiMode) {
     dma.free(); // Deallocate DMA channel
   }
 #endif // end USE_SPI_DMA
+
+#if defined(USE_PARTICLE_SPI_DMA)
+  if ((connection == TFT_HARD_SPI) && !pixelBuf[0]) {
+    // 2 scanlines on the major axis, split into two one-line blocks: the
+    // CPU byte-swaps into one while the other is being transferred. If
+    // the malloc fails, writePixels() just uses the blocking loop.
+    int major = (WIDTH > HEIGHT) ? WIDTH : HEIGHT;
+    if ((pixelBuf[0] = (uint16_t *)malloc(major * 2 * sizeof(uint16_t)))) {
+      pixelBuf[1] = &pixelBuf[0][major];
+      maxFillLen = major * 2;
+      pixelBufIdx = 0;
+    }
+  }
+  if ((connection == TFT_HARD_SPI) && !fillBuf) {
+    // Separate from pixelBuf so a solid fill survives writePixels() calls
+    // and the same color can be reused without refilling (lastFillColor).
+    int major = (WIDTH > HEIGHT) ? WIDTH : HEIGHT;
+    major += (major & 1); // -> next 2-pixel bound, if needed.
+    if ((fillBuf = (uint16_t *)malloc(major * SPITFT_FILL_LINES *
+                                      sizeof(uint16_t)))) {
+      fillBufLen = major * SPITFT_FILL_LINES;
+      lastFillColor = 0x0000;
+      lastFillLen = 0;
+    }
+  }
+#endif // end USE_PARTICLE_SPI_DMA
 }
 
 /*!
@@ -911,6 +967,7 @@ void Adafruit_SPITFT::setSPISpeed(uint32_t freq) {
             for all display types; not an SPI-specific function.
 */
 void Adafruit_SPITFT::startWrite(void) {
+  INSTR_HOOK_START(INSTR_HOOK_TFT);
   SPI_BEGIN_TRANSACTION();
   if (_cs >= 0)
     SPI_CS_LOW();
@@ -926,6 +983,7 @@ void Adafruit_SPITFT::endWrite(void) {
   if (_cs >= 0)
     SPI_CS_HIGH();
   SPI_END_TRANSACTION();
+  INSTR_HOOK_STOP(INSTR_HOOK_TFT);
 }
 
 // -------------------------------------------------------------------------
@@ -945,6 +1003,7 @@ void Adafruit_SPITFT::endWrite(void) {
 */
 void Adafruit_SPITFT::writePixel(int16_t x, int16_t y, uint16_t color) {
   if ((x >= 0) && (x < _width) && (y >= 0) && (y < _height)) {
+    STAT_PIXELS(1);
     setAddrWindow(x, y, 1, 1);
     SPI_WRITE16(color);
   }
@@ -998,6 +1057,7 @@ void Adafruit_SPITFT::writePixels(uint16_t *colors, uint32_t len, bool block,
 
   if (!len)
     return; // Avoid 0-byte transfers
+  STAT_PIXELS(len);
 
   // avoid paramater-not-used complaints
   (void)block;
@@ -1128,10 +1188,50 @@ void Adafruit_SPITFT::writePixels(uint16_t *colors, uint32_t len, bool block,
     }
     return;
   }
+#elif defined(USE_PARTICLE_SPI_DMA)
+  if ((connection == TFT_HARD_SPI) && pixelBuf[0]) {
+    if (!bigEndian) {
+      int maxSpan = maxFillLen / 2; // One block (scanline) max
+      while (len) {
+        uint32_t count = (len < (uint32_t)maxSpan) ? len : maxSpan;
+
+        // The block being filled is never the one in flight, so the
+        // swap overlaps the previous transfer.
+        swapBytes(colors, count, pixelBuf[pixelBufIdx]);
+        colors += count;
+
+        while (dma_busy)
+          ; // Wait for prior block to finish
+        dma_busy = true;
+        hwspi._spi->transfer(pixelBuf[pixelBufIdx], NULL, count * 2,
+                             dma_callback);
+        SPI_BYTES(count * 2);
+        pixelBufIdx = 1 - pixelBufIdx; // Swap DMA pixel buffers
+
+        len -= count;
+      }
+    } else { // bigEndian == true
+      // Already in display order, send straight from the caller's buffer
+      // (which must then stay untouched until dmaWait() if !block).
+      while (dma_busy)
+        ;
+      dma_busy = true;
+      hwspi._spi->transfer(colors, NULL, len * 2, dma_callback);
+      SPI_BYTES(len * 2);
+    }
+    if (block) {
+      while (dma_busy)
+        ; // Wait for last block to complete
+    }
+    return;
+  }
 #endif // end USE_SPI_DMA
 
   // All other cases (bitbang SPI or non-DMA hard SPI or parallel),
   // use a loop with the normal 16-bit data write function:
+#if defined(USE_PARTICLE_SPI_DMA)
+  dmaWait(); // Behind any writeColor() fill still running
+#endif
 
   if (!bigEndian) {
     while (len--) {
@@ -1169,6 +1269,9 @@ void Adafruit_SPITFT::dmaWait(void) {
     pinPeripheral(tft8._wr, PIO_OUTPUT); // Switch WR back to GPIO
   }
 #endif // end __SAMD51__ || ARDUINO_SAMD_ZERO
+#elif defined(USE_PARTICLE_SPI_DMA)
+  while (dma_busy)
+    ;
 #endif
 }
 
@@ -1178,7 +1281,9 @@ void Adafruit_SPITFT::dmaWait(void) {
     @return true if DMA is enabled and transmitting data, false otherwise.
 */
 bool Adafruit_SPITFT::dmaBusy(void) const {
-#if defined(USE_SPI_DMA) && (defined(__SAMD51__) || defined(ARDUINO_SAMD_ZERO))
+#if (defined(USE_SPI_DMA) &&                                                  \
+     (defined(__SAMD51__) || defined(ARDUINO_SAMD_ZERO))) ||                   \
+    defined(USE_PARTICLE_SPI_DMA)
   return dma_busy;
 #else
   return false;
@@ -1195,6 +1300,7 @@ void Adafruit_SPITFT::writeColor(uint16_t color, uint32_t len) {
 
   if (!len)
     return; // Avoid 0-byte transfers
+  STAT_PIXELS(len);
 
   uint8_t hi = color >> 8, lo = color;
 
@@ -1337,12 +1443,53 @@ void Adafruit_SPITFT::writeColor(uint16_t color, uint32_t len) {
 #endif // end __SAMD51__
     return;
   }
+#elif defined(USE_PARTICLE_SPI_DMA)
+  if ((connection == TFT_HARD_SPI) && fillBuf &&
+      (len >= 16)) { // Don't bother with DMA on short pixel runs
+    // Same buffer handling as the SAMD path above: the buffer holds the
+    // color already byte-swapped for the display, 2 pixels per 32 bits,
+    // and only grows (or is redone) when the color or length changes.
+    uint32_t i, *pixelPtr = (uint32_t *)fillBuf,
+                twoPixels = __builtin_bswap16(color) * 0x00010001;
+    uint32_t fillEnd = (((len < fillBufLen) ? len : fillBufLen) + 1) / 2;
+    if ((color != lastFillColor) || (fillEnd * 2 > lastFillLen)) {
+      while (dma_busy)
+        ; // A previous fill may still be reading the buffer
+      if (color == lastFillColor) {
+        for (i = lastFillLen / 2; i < fillEnd; i++)
+          pixelPtr[i] = twoPixels;
+      } else {
+        for (i = 0; i < fillEnd; i++)
+          pixelPtr[i] = twoPixels;
+        lastFillColor = color;
+      }
+      lastFillLen = fillEnd * 2;
+    }
+
+    // The buffer is read-only from here, so each chunk can start as soon
+    // as the one before it is done. The last one is left running; the
+    // next command or endWrite() waits for it.
+    while (len) {
+      uint32_t count = (len < lastFillLen) ? len : lastFillLen;
+      while (dma_busy)
+        ;
+      dma_busy = true;
+      hwspi._spi->transfer(fillBuf, NULL, count * 2, dma_callback);
+      SPI_BYTES(count * 2);
+      len -= count;
+    }
+    return;
+  }
 #endif // end USE_SPI_DMA
 #endif // end !ESP32
 
   // All other cases (non-DMA hard SPI, bitbang SPI, parallel)...
 
   if (connection == TFT_HARD_SPI) {
+#if defined(USE_PARTICLE_SPI_DMA)
+    dmaWait(); // Short runs go byte by byte behind any fill still running
+#endif
+    SPI_BYTES(len * 2);
 #if defined(ESP8266)
     do {
       uint32_t pixelsThisPass = len;
@@ -1646,6 +1793,7 @@ inline void Adafruit_SPITFT::writeFillRectPreclipped(int16_t x, int16_t y,
 void Adafruit_SPITFT::drawPixel(int16_t x, int16_t y, uint16_t color) {
   // Clip first...
   if ((x >= 0) && (x < _width) && (y >= 0) && (y < _height)) {
+    STAT_PIXELS(1);
     // THEN set up transaction (if needed) and draw...
     startWrite();
     setAddrWindow(x, y, 1, 1);
@@ -1864,6 +2012,64 @@ void Adafruit_SPITFT::drawRGBBitmap(int16_t x, int16_t y, uint16_t *pcolors,
   endWrite();
 }
 
+/*!
+    @brief  Draw an opaque 'classic' font glyph with a single address window.
+            The scaled glyph is expanded into a pixel buffer, row by row, and
+            pushed with writePixels() whenever the buffer fills, so a size 3
+            character is one setAddrWindow() and one writePixels() instead of
+            up to 48 separate fills. Called by drawChar() inside a
+            transaction, with the cell already known to be onscreen.
+    @param  x       Top left corner horizontal coordinate.
+    @param  y       Top left corner vertical coordinate.
+    @param  glyph   The 5 column bytes of the character, LSB at the top.
+    @param  color   16-bit 5-6-5 foreground color.
+    @param  bg      16-bit 5-6-5 background color.
+    @param  size_x  Font magnification level in X-axis.
+    @param  size_y  Font magnification level in Y-axis.
+    @return false if one scaled row doesn't fit SPITFT_GLYPH_PIXELS, in
+            which case nothing was drawn.
+*/
+bool Adafruit_SPITFT::writeGlyph(int16_t x, int16_t y, const uint8_t *glyph,
+                                 uint16_t color, uint16_t bg, uint8_t size_x,
+                                 uint8_t size_y) {
+  uint16_t pixels[SPITFT_GLYPH_PIXELS];
+  uint16_t w = 6 * size_x; // 5 font columns + 1 column of spacing
+  uint32_t n = 0;
+
+  if (w > SPITFT_GLYPH_PIXELS)
+    return false;
+
+  setAddrWindow(x, y, w, 8 * size_y);
+  for (uint8_t j = 0; j < 8; j++) { // Char bitmap = 8 rows
+    uint16_t *row = &pixels[n];
+    uint16_t *p = row;
+    for (uint8_t i = 0; i < 5; i++) {
+      uint16_t c = (glyph[i] & (1 << j)) ? color : bg;
+      for (uint8_t k = 0; k < size_x; k++)
+        *p++ = c;
+    }
+    for (uint8_t k = 0; k < size_x; k++)
+      *p++ = bg;
+    n += w;
+    for (uint8_t k = 1; k < size_y; k++) { // Repeat the row size_y times
+      if (n + w > SPITFT_GLYPH_PIXELS) {
+        writePixels(pixels, n);
+        memmove(pixels, row, w * sizeof(uint16_t));
+        row = pixels;
+        n = w;
+      }
+      memcpy(&pixels[n], row, w * sizeof(uint16_t));
+      n += w;
+    }
+    if (n + w > SPITFT_GLYPH_PIXELS) { // No room for the next font row
+      writePixels(pixels, n);
+      n = 0;
+    }
+  }
+  writePixels(pixels, n);
+  return true;
+}
+
 // -------------------------------------------------------------------------
 // Miscellaneous class member functions that don't draw anything.
 
@@ -2092,6 +2298,9 @@ inline void Adafruit_SPITFT::SPI_BEGIN_TRANSACTION(void) {
             function that encapsulated both actions.
 */
 inline void Adafruit_SPITFT::SPI_END_TRANSACTION(void) {
+#if defined(USE_PARTICLE_SPI_DMA)
+  dmaWait(); // Keep the bus until the last DMA block is out
+#endif
 #if defined(SPI_HAS_TRANSACTION)
   if (connection == TFT_HARD_SPI) {
     hwspi._spi->endTransaction();
@@ -2110,6 +2319,7 @@ inline void Adafruit_SPITFT::SPI_END_TRANSACTION(void) {
 */
 void Adafruit_SPITFT::spiWrite(uint8_t b) {
   if (connection == TFT_HARD_SPI) {
+    SPI_BYTES(1);
 #if defined(__AVR__)
     AVR_WRITESPI(b);
 #elif defined(ESP8266) || defined(ESP32)
@@ -2394,6 +2604,7 @@ inline bool Adafruit_SPITFT::SPI_MISO_READ(void) {
 */
 void Adafruit_SPITFT::SPI_WRITE16(uint16_t w) {
   if (connection == TFT_HARD_SPI) {
+    SPI_BYTES(2);
 #if defined(__AVR__)
     AVR_WRITESPI(w >> 8);
     AVR_WRITESPI(w);
@@ -2448,6 +2659,7 @@ void Adafruit_SPITFT::SPI_WRITE16(uint16_t w) {
 */
 void Adafruit_SPITFT::SPI_WRITE32(uint32_t l) {
   if (connection == TFT_HARD_SPI) {
+    SPI_BYTES(4);
 #if defined(__AVR__)
     AVR_WRITESPI(l >> 24);
     AVR_WRITESPI(l >> 16);
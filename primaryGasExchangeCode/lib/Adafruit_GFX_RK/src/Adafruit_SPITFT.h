@@ -92,6 +92,29 @@ typedef volatile ADAGFX_PORT_t *PORTreg_t; ///< PORT register type
 #include <Adafruit_ZeroDMA.h>
 #endif
 
+// Particle Device OS has a DMA-backed asynchronous SPI.transfer(tx, rx, len,
+// callback) on every platform, so hardware SPI pixel pushes use it unless
+// this is defined. RAM usage: 2 scanlines on the display's major axis,
+// e.g. 480x320 pixels = 480 * 2 * 2 = 1,920 bytes.
+#if defined(PARTICLE) && !defined(SPITFT_NO_PARTICLE_DMA)
+#define USE_PARTICLE_SPI_DMA ///< Async SPI.transfer() for writePixels()
+#endif
+// Scanlines in the Particle writeColor() fill buffer, another 2 bytes/pixel
+// on the major axis per line (4 lines at 480 pixels = 3,840 bytes).
+#ifndef SPITFT_FILL_LINES
+#define SPITFT_FILL_LINES 4
+#endif
+// If set, count the pixels written and the bytes put on hardware SPI (see
+// statPixels, statBytes). Used by the DisplayBenchmark library. Costs an add
+// per SPI write, so it's off unless needed.
+// #define SPITFT_STATS
+
+// Pixel buffer (on the stack) used by writeGlyph(). 512 pixels holds a whole
+// size 3 glyph (18x24); bigger glyphs go out in several bursts of rows.
+#ifndef SPITFT_GLYPH_PIXELS
+#define SPITFT_GLYPH_PIXELS 512
+#endif
+
 // This is kind of a kludge. Needed a way to disambiguate the software SPI
 // and parallel constructors via their argument lists. Originally tried a
 // bool as the first argument to the parallel constructor (specifying 8-bit
@@ -237,6 +260,14 @@ public:
   // user code, so it's public...
   bool dmaBusy(void) const; // true if DMA is used and busy, false otherwise
   void swapBytes(uint16_t *src, uint32_t len, uint16_t *dest = NULL);
+#if defined(SPITFT_STATS)
+  uint32_t statPixels = 0; ///< Pixels written since resetStats()
+  uint32_t statBytes = 0;  ///< Bytes sent on hardware SPI since resetStats()
+  /*!
+      @brief  Zero the pixel and byte counters.
+  */
+  void resetStats(void) { statPixels = statBytes = 0; }
+#endif
 
   // These functions are similar to the 'write' functions above, but with
   // a chip-select and/or SPI transaction built-in. They're typically used
@@ -290,6 +321,9 @@ public:
               connection is parallel.
   */
   void SPI_CS_HIGH(void) {
+#if defined(USE_PARTICLE_SPI_DMA)
+    dmaWait(); // Don't deselect while pixels are still going out
+#endif
 #if defined(USE_FAST_PINIO)
 #if defined(HAS_PORT_SET_CLR)
 #if defined(KINETISK)
@@ -350,6 +384,9 @@ public:
       @brief  Set the data/command line LOW (command mode).
   */
   void SPI_DC_LOW(void) {
+#if defined(USE_PARTICLE_SPI_DMA)
+    dmaWait(); // A command mid-transfer would turn pixels into commands
+#endif
 #if defined(USE_FAST_PINIO)
 #if defined(HAS_PORT_SET_CLR)
 #if defined(KINETISK)
@@ -366,6 +403,11 @@ public:
   }
 
 protected:
+  // Streams an opaque classic-font glyph through one address window
+  // instead of a writeFillRect() per font pixel (see drawChar()).
+  bool writeGlyph(int16_t x, int16_t y, const uint8_t *glyph, uint16_t color,
+                  uint16_t bg, uint8_t size_x, uint8_t size_y);
+
   // A few more low-level member functions -- some may have previously
   // been macros. Shouldn't have a need to access these externally, so
   // they've been moved to the protected section. Additionally, they're
@@ -501,6 +543,15 @@ protected:
   uint32_t lastFillLen = 0;          ///< # of pixels w/last fill
   uint8_t onePixelBuf;               ///< For hi==lo fill
 #endif
+#if defined(USE_PARTICLE_SPI_DMA)
+  uint16_t *pixelBuf[2] = {NULL, NULL}; ///< Double-buffered DMA blocks
+  uint16_t maxFillLen = 0;              ///< Pixels in both blocks together
+  uint8_t pixelBufIdx = 0;              ///< Block the CPU fills next
+  uint16_t *fillBuf = NULL;             ///< Byte-swapped writeColor() pixels
+  uint32_t fillBufLen = 0;              ///< Size of fillBuf in pixels
+  uint16_t lastFillColor = 0;           ///< Last color used w/fill
+  uint32_t lastFillLen = 0;             ///< # of pixels w/last fill
+#endif
 #if defined(USE_FAST_PINIO)
 #if defined(HAS_PORT_SET_CLR)
 #if !defined(KINETISK)
@@ -1,4 +1,5 @@
 #include "Adafruit_HDC302x.h"
+#include "InstrumentationHooks.h"
 
 /**
  * Constructor for the HDC302x sensor driver.
@@ -42,13 +43,25 @@ bool Adafruit_HDC302x::begin(uint8_t i2cAddr, TwoWire *wire) {
 }
 
 /**
- * Sets the auto mode for measurements.
+ * Sets the auto mode for measurements. When switching from one auto rate to
+ * another the sensor is put back to sleep first, it ignores a new mode
+ * command while it is still running auto conversions.
  *
  * @param mode The desired auto mode.
+ * @return true if the mode command was sent successfully, otherwise false.
  */
-void Adafruit_HDC302x::setAutoMode(hdcAutoMode_t mode) {
+bool Adafruit_HDC302x::setAutoMode(hdcAutoMode_t mode) {
+  if (currentAutoMode != EXIT_AUTO_MODE && mode != EXIT_AUTO_MODE) {
+    if (!writeCommand(EXIT_AUTO_MODE)) {
+      return false;
+    }
+    currentAutoMode = EXIT_AUTO_MODE;
+  }
+  if (!writeCommand(mode)) {
+    return false;
+  }
   currentAutoMode = mode;
-  writeCommand(mode);
+  return true;
 }
 
 /**
@@ -59,7 +72,32 @@ void Adafruit_HDC302x::setAutoMode(hdcAutoMode_t mode) {
 hdcAutoMode_t Adafruit_HDC302x::getAutoMode() const { return currentAutoMode; }
 
 /**
- * Reads the temperature and humidity in auto mode.
+ * Gets the time between two results for an auto mode.
+ *
+ * @param mode The auto mode.
+ * @return The measurement period in milliseconds, 0 for EXIT_AUTO_MODE.
+ */
+uint16_t Adafruit_HDC302x::autoModePeriod(hdcAutoMode_t mode) {
+  // The rate is encoded in the command MSB
+  switch (mode >> 8) {
+  case 0x20:
+    return 2000;
+  case 0x21:
+    return 1000;
+  case 0x22:
+    return 500;
+  case 0x23:
+    return 250;
+  case 0x27:
+    return 100;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * Reads the temperature and humidity in auto mode. The sensor keeps the last
+ * result of its own conversions, so this is a bare readout with no wait.
  *
  * @param temp Reference to store the temperature value.
  * @param RH Reference to store the relative humidity value.
@@ -67,7 +105,10 @@ hdcAutoMode_t Adafruit_HDC302x::getAutoMode() const { return currentAutoMode; }
  * otherwise false.
  */
 bool Adafruit_HDC302x::readAutoTempRH(double &temp, double &RH) {
-  return sendCommandReadTRH(MEASUREMENT_READOUT_AUTO_MODE, temp, RH);
+  if (!writeCommand(MEASUREMENT_READOUT_AUTO_MODE)) {
+    return false;
+  }
+  return readTRH(temp, RH);
 }
 
 /**
@@ -83,31 +124,93 @@ bool Adafruit_HDC302x::readAutoTempRH(double &temp, double &RH) {
  */
 bool Adafruit_HDC302x::readTemperatureHumidityOnDemand(
     double &temp, double &RH, hdcTriggerMode_t mode = TRIGGERMODE_LP0) {
-  return sendCommandReadTRH(static_cast<uint16_t>(mode), temp, RH);
+  if (!startMeasurement(mode)) {
+    return false;
+  }
+  INSTR_HOOK_DELAY(measureTime);
+  return fetch(temp, RH);
 }
 
 /**
- * Sends a command and reads the temperature and humidity.
+ * Triggers a single on-demand measurement and returns without waiting for the
+ * conversion. Poll isReady() and then collect the result with fetch().
+ *
+ * @param mode The trigger mode to use for the measurement, defaults to
+ * TRIGGERMODE_LP0 (lowest noise)
+ * @return true if the trigger command was sent successfully, otherwise false.
+ */
+bool Adafruit_HDC302x::startMeasurement(hdcTriggerMode_t mode) {
+  measurePending = false;
+  if (!writeCommand(static_cast<uint16_t>(mode))) {
+    return false;
+  }
+  measureStart = millis();
+  measureTime = conversionTime(mode);
+  measurePending = true;
+  return true;
+}
+
+/**
+ * Checks whether a measurement started with startMeasurement() has had time
+ * to finish converting. Does not touch the I2C bus.
+ *
+ * @return true if a measurement is pending and its conversion time has
+ * elapsed, otherwise false.
+ */
+bool Adafruit_HDC302x::isReady() {
+  return measurePending && ((millis() - measureStart) >= measureTime);
+}
+
+/**
+ * Reads the result of a measurement started with startMeasurement().
  *
- * @param command The command to send.
  * @param temp Reference to store the temperature value.
  * @param RH Reference to store the relative humidity value.
  * @return true if the data was successfully read and CRC checks passed,
  * otherwise false.
  */
-bool Adafruit_HDC302x::sendCommandReadTRH(uint16_t command, double &temp,
-                                          double &RH) {
-  // Trigger the temperature and humidity measurement
-  if (!writeCommand(command)) {
+bool Adafruit_HDC302x::fetch(double &temp, double &RH) {
+  if (!measurePending) {
     return false;
   }
+  measurePending = false;
+  return readTRH(temp, RH);
+}
 
-  // Wait for conversion (tmeas in datasheet table 7.5)
-  delay(20);
+/**
+ * Gets the worst case conversion time for a trigger mode.
+ *
+ * @param mode The trigger mode.
+ * @return The conversion time in milliseconds (tmeas max in datasheet table
+ * 7.5, rounded up).
+ */
+uint8_t Adafruit_HDC302x::conversionTime(hdcTriggerMode_t mode) {
+  switch (mode) {
+  case TRIGGERMODE_LP1:
+    return 8;
+  case TRIGGERMODE_LP2:
+    return 5;
+  case TRIGGERMODE_LP3:
+    return 4;
+  case TRIGGERMODE_LP0:
+  default:
+    return 13;
+  }
+}
 
-  // Read results
+/**
+ * Reads and converts the 6 byte temperature/humidity result.
+ *
+ * @param temp Reference to store the temperature value.
+ * @param RH Reference to store the relative humidity value.
+ * @return true if the data was successfully read and CRC checks passed,
+ * otherwise false.
+ */
+bool Adafruit_HDC302x::readTRH(double &temp, double &RH) {
   uint8_t buffer[6];
-  i2c_dev->read(buffer, 6);
+  if (!i2c_dev->read(buffer, 6)) {
+    return false;
+  }
 
   // Validate CRC for temperature data
   if (calculateCRC8(buffer, 2) != buffer[2]) {
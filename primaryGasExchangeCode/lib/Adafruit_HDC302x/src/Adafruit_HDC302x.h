@@ -85,12 +85,18 @@ public:
   bool writeOffsets(double T, double RH);
   bool readOffsets(double &T, double &RH);
 
-  void setAutoMode(hdcAutoMode_t mode);
+  bool setAutoMode(hdcAutoMode_t mode);
   hdcAutoMode_t getAutoMode() const;
+  static uint16_t autoModePeriod(hdcAutoMode_t mode);
   bool readAutoTempRH(double &temp, double &RH);
   bool readTemperatureHumidityOnDemand(double &temp, double &RH,
                                        hdcTriggerMode_t mode);
 
+  bool startMeasurement(hdcTriggerMode_t mode = TRIGGERMODE_LP0);
+  bool isReady();
+  bool fetch(double &temp, double &RH);
+  static uint8_t conversionTime(hdcTriggerMode_t mode);
+
   bool setHighAlert(float T, float RH);
   bool setLowAlert(float T, float RH);
   bool clearHighAlert(float T, float RH);
@@ -107,8 +113,12 @@ private:
   bool writeCommand(uint16_t command);
   bool writeCommandData(uint16_t cmd, uint16_t data);
   bool writeCommandReadData(uint16_t command, uint16_t &data);
-  bool sendCommandReadTRH(uint16_t command, double &temp, double &RH);
+  bool readTRH(double &temp, double &RH);
   hdcAutoMode_t currentAutoMode;
+
+  bool measurePending = false;
+  uint32_t measureStart = 0;
+  uint8_t measureTime = 0;
 };
 
 #endif // ADAFRUIT_HDC302X_H
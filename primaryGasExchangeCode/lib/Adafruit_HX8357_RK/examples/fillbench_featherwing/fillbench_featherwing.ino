@@ -0,0 +1,89 @@
+/***************************************************
+  Solid fill microbenchmark for the Adafruit 3.5" TFT (HX8357) FeatherWing
+  ----> http://www.adafruit.com/products/3651
+
+  Times fillScreen() and small fillRect() clears, which both end up in
+  writeColor(), and prints each next to the SPI wire-speed limit (16 bits
+  per pixel at the SPI clock). With the Particle DMA fill path a full
+  screen clear should come in close to that limit; build with
+  -DSPITFT_NO_PARTICLE_DMA to compare against the byte-at-a-time loop.
+
+  MIT license, all text above must be included in any redistribution
+ ****************************************************/
+
+#include "Adafruit_GFX.h"
+#include "Adafruit_HX8357.h"
+
+#if defined(PARTICLE)
+   #define TFT_DC   D5
+   #define TFT_CS   D4
+#else
+   #define TFT_DC   10
+   #define TFT_CS   9
+#endif
+#define TFT_RST -1
+
+#define SPI_FREQ 24000000 // HX8357 default on ARM, see Adafruit_HX8357.cpp
+#define RUNS     10
+
+Adafruit_HX8357 tft(TFT_CS, TFT_DC, TFT_RST);
+
+
+void setup() {
+  Serial.begin(115200);
+  delay(3000);
+
+  tft.begin();
+  tft.setRotation(1);
+
+  Serial.println(F("Benchmark              us/call   Mpixel/s   wire limit us"));
+
+  // Same color every time: the fill buffer is reused as is
+  report("fillScreen same color ", testFillScreen(false), (uint32_t)tft.width() * tft.height());
+  // New color every time: the fill buffer is rebuilt on each call
+  report("fillScreen new color  ", testFillScreen(true), (uint32_t)tft.width() * tft.height());
+  // One value field clear from the dashboard, 95x24
+  report("fillRect 95x24        ", testFillRect(95, 24), 95UL * 24);
+  // One scanline, the shortest run that still goes through DMA
+  report("fillRect 480x1        ", testFillRect(480, 1), 480UL);
+
+  Serial.println(F("Done!"));
+}
+
+
+void loop(void) {
+}
+
+void report(const char *name, unsigned long us, uint32_t pixels) {
+  unsigned long wire = (unsigned long)((uint64_t)pixels * 16 * 1000000 / SPI_FREQ);
+
+  Serial.printf("%s %9lu %10.2f %15lu\n", name, us, (float)pixels / us, wire);
+}
+
+// Average time of one full screen fill
+unsigned long testFillScreen(bool alternate) {
+  const uint16_t colors[] = { HX8357_RED, HX8357_GREEN, HX8357_BLUE, HX8357_WHITE };
+  unsigned long start;
+  int i;
+
+  tft.fillScreen(HX8357_BLACK);
+  start = micros();
+  for(i = 0; i < RUNS; i++) {
+    tft.fillScreen(alternate ? colors[i & 3] : HX8357_BLACK);
+  }
+  tft.dmaWait();
+  return (micros() - start) / RUNS;
+}
+
+// Average time of one w x h fill, spread over the screen
+unsigned long testFillRect(int w, int h) {
+  unsigned long start;
+  int i, n = 100;
+
+  start = micros();
+  for(i = 0; i < n; i++) {
+    tft.fillRect((i * 37) % (tft.width() - w + 1), (i * 23) % (tft.height() - h + 1), w, h, HX8357_BLACK);
+  }
+  tft.dmaWait();
+  return (micros() - start) / n;
+}
@@ -41,6 +41,7 @@
 
 #include <stdlib.h>
 #include <SPI.h>
+#include "InstrumentationHooks.h"
 
 static SPISettings max31856_spisettings = SPISettings(500000, MSBFIRST, SPI_MODE2);
 
@@ -52,25 +53,34 @@ static SPISettings max31856_spisettings = SPISettings(500000, MSBFIRST, SPI_MODE
     @param  spi_mosi Bitbang SPI MOSI
     @param  spi_miso Bitbang SPI MISO
     @param  spi_clk Bitbang SPI Clock
+    @param  drdy Optional DRDY pin, -1 to time conversions instead
 */
 /**************************************************************************/
-Adafruit_MAX31856::Adafruit_MAX31856(int8_t spi_cs, int8_t spi_mosi, int8_t spi_miso, int8_t spi_clk) {
+Adafruit_MAX31856::Adafruit_MAX31856(int8_t spi_cs, int8_t spi_mosi, int8_t spi_miso, int8_t spi_clk, int8_t drdy) {
   _sclk = spi_clk;
   _cs = spi_cs;
   _miso = spi_miso;
   _mosi = spi_mosi;
-
+  _drdy = drdy;
+  _conversionMode = MAX31856_ONESHOT;
+  _conversionStart = 0;
+  _conversionTime = 0;
 }
 
 /**************************************************************************/
 /*!
     @brief  Instantiate MAX31856 object and use hardware SPI
     @param  spi_cs Any pin for SPI Chip Select
+    @param  drdy Optional DRDY pin, -1 to time conversions instead
 */
 /**************************************************************************/
-Adafruit_MAX31856::Adafruit_MAX31856(int8_t spi_cs) {
+Adafruit_MAX31856::Adafruit_MAX31856(int8_t spi_cs, int8_t drdy) {
   _cs = spi_cs;
   _sclk = _miso = _mosi = -1;
+  _drdy = drdy;
+  _conversionMode = MAX31856_ONESHOT;
+  _conversionStart = 0;
+  _conversionTime = 0;
 }
 
 /**************************************************************************/
@@ -93,6 +103,10 @@ boolean Adafruit_MAX31856::begin(void) {
     SPI1.begin();
   }
 
+  if (_drdy != -1) {
+    pinMode(_drdy, INPUT);
+  }
+
   // assert on any fault
   writeRegister8(MAX31856_MASK_REG, 0x0);
   
@@ -208,35 +222,204 @@ void Adafruit_MAX31856::oneShotTemperature(void) {
 
   writeRegister8(MAX31856_CR0_REG, t);
 
-  delay(250); // MEME FIX autocalculate based on oversampling
+  _conversionStart = millis();
+  _conversionTime = conversionTime();
+  INSTR_HOOK_DELAY(_conversionTime);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Pick how the read functions get a conversion. MAX31856_ONESHOT
+    keeps the old blocking behavior, MAX31856_ONESHOT_NOWAIT leaves triggering
+    to triggerOneShot(), MAX31856_CONTINUOUS turns on auto conversion.
+    @param  mode One of the max31856_conversion_modes_t values
+*/
+/**************************************************************************/
+void Adafruit_MAX31856::setConversionMode(max31856_conversion_modes_t mode) {
+  uint8_t t = readRegister8(MAX31856_CR0_REG);
+  if (mode == MAX31856_CONTINUOUS) {
+    t |= MAX31856_CR0_AUTOCONVERT;
+    t &= ~MAX31856_CR0_1SHOT;
+  } else {
+    t &= ~MAX31856_CR0_AUTOCONVERT;
+  }
+  writeRegister8(MAX31856_CR0_REG, t);
+
+  _conversionMode = mode;
+  _conversionStart = millis();
+  _conversionTime = conversionTime();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the conversion mode set with setConversionMode()
+    @returns One of the max31856_conversion_modes_t values
+*/
+/**************************************************************************/
+max31856_conversion_modes_t Adafruit_MAX31856::getConversionMode(void) {
+  return _conversionMode;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set how many samples the chip averages per conversion. More
+    samples means less noise and a longer conversion.
+    @param  mode One of the max31856_averaging_t values
+*/
+/**************************************************************************/
+void Adafruit_MAX31856::setAveragingMode(max31856_averaging_t mode) {
+  uint8_t t = readRegister8(MAX31856_CR1_REG);
+  t &= ~MAX31856_CR1_AVGSEL_MASK;
+  t |= ((uint8_t)mode << 4) & MAX31856_CR1_AVGSEL_MASK;
+  writeRegister8(MAX31856_CR1_REG, t);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the number of samples averaged per conversion
+    @returns One of the max31856_averaging_t values
+*/
+/**************************************************************************/
+max31856_averaging_t Adafruit_MAX31856::getAveragingMode(void) {
+  uint8_t t = readRegister8(MAX31856_CR1_REG);
+  return (max31856_averaging_t)((t & MAX31856_CR1_AVGSEL_MASK) >> 4);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Start a one-shot conversion and return right away. Poll
+    conversionComplete() and then read the thermocouple and cold junction
+    temperatures of that same conversion.
+*/
+/**************************************************************************/
+void Adafruit_MAX31856::triggerOneShot(void) {
+  uint8_t t = readRegister8(MAX31856_CR0_REG);
+
+  t &= ~MAX31856_CR0_AUTOCONVERT; // turn off autoconvert!
+  t |= MAX31856_CR0_1SHOT;
+
+  writeRegister8(MAX31856_CR0_REG, t);
+
+  _conversionStart = millis();
+  _conversionTime = conversionTime();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check if the last conversion is done. Uses the DRDY pin when one
+    was given, otherwise the conversionTime() taken when it was started, so
+    polling costs no SPI traffic.
+    @returns True if a result is ready to read
+*/
+/**************************************************************************/
+bool Adafruit_MAX31856::conversionComplete(void) {
+  if (_drdy != -1) {
+    return !digitalRead(_drdy); // DRDY is active low
+  }
+  return (millis() - _conversionStart) >= _conversionTime;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Worst case conversion time for the current averaging and noise
+    filter settings (datasheet electrical characteristics, rounded up)
+    @returns Conversion time in milliseconds
+*/
+/**************************************************************************/
+uint16_t Adafruit_MAX31856::conversionTime(void) {
+  uint8_t cr0 = readRegister8(MAX31856_CR0_REG);
+  uint8_t cr1 = readRegister8(MAX31856_CR1_REG);
+  bool filter50Hz = cr0 & 0x01;
+  uint8_t samples = 1 << ((cr1 & MAX31856_CR1_AVGSEL_MASK) >> 4);
+  if (samples > 16) {
+    samples = 16; // AVGSEL 1xx all mean 16 samples
+  }
+
+  uint16_t first, extra;
+  if (_conversionMode == MAX31856_CONTINUOUS) {
+    first = filter50Hz ? 120 : 100;
+  } else {
+    first = filter50Hz ? 185 : 155;
+  }
+  extra = filter50Hz ? 40 : 34;
+
+  return first + (samples - 1) * extra;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Start a one-shot measurement and return internal chip temperature
+    @brief  Return internal chip temperature. In MAX31856_ONESHOT mode this
+    starts a conversion and waits for it first.
     @returns Floating point temperature of chip in Celsius
 */
 /**************************************************************************/
 float Adafruit_MAX31856::readCJTemperature(void) {
-  oneShotTemperature();
+  if (_conversionMode == MAX31856_ONESHOT) {
+    oneShotTemperature();
+  }
 
-  int16_t temp16 = readRegister16(MAX31856_CJTH_REG);
-  float tempfloat = temp16;
-  tempfloat /= 256.0;
+  uint8_t buffer[2] = {0, 0};
+  readRegisterN(MAX31856_CJTH_REG, buffer, 2);
 
-  return tempfloat;
+  return decodeCJTemperature(buffer);
 }
 
 /**************************************************************************/
 /*!
-    @brief  Start a one-shot measurement and return thermocouple tip temperature
+    @brief  Return thermocouple tip temperature. In MAX31856_ONESHOT mode
+    this starts a conversion and waits for it first.
     @returns Floating point temperature at end of thermocouple in Celsius
 */
 /**************************************************************************/
 float Adafruit_MAX31856::readThermocoupleTemperature(void) {
-  oneShotTemperature();
+  if (_conversionMode == MAX31856_ONESHOT) {
+    oneShotTemperature();
+  }
+
+  uint8_t buffer[3] = {0, 0, 0};
+  readRegisterN(MAX31856_LTCBH_REG, buffer, 3);
+
+  return decodeThermocoupleTemperature(buffer);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read cold junction, thermocouple and fault status in one burst
+    (CJTH through SR, 6 bytes in a single chip select window), so all three
+    come from the same conversion. In MAX31856_ONESHOT mode this starts a
+    conversion and waits for it first.
+    @param  conversion Filled with both temperatures and the fault flags
+    @returns True if no fault flag is set
+*/
+/**************************************************************************/
+bool Adafruit_MAX31856::readConversion(max31856_conversion_t *conversion) {
+  if (_conversionMode == MAX31856_ONESHOT) {
+    oneShotTemperature();
+  }
+
+  // CJTH, CJTL, LTCBH, LTCBM, LTCBL, SR
+  uint8_t buffer[6] = {0, 0, 0, 0, 0, 0};
+  readRegisterN(MAX31856_CJTH_REG, buffer, 6);
+
+  conversion->coldJunction = decodeCJTemperature(buffer);
+  conversion->thermocouple = decodeThermocoupleTemperature(buffer + 2);
+  conversion->fault = buffer[5];
+
+  return conversion->fault == 0;
+}
+
+/**********************************************/
+
+float Adafruit_MAX31856::decodeCJTemperature(const uint8_t buffer[2]) {
+  int16_t temp16 = ((uint16_t)buffer[0] << 8) | buffer[1];
+  float tempfloat = temp16;
+  tempfloat /= 256.0;
+
+  return tempfloat;
+}
 
-  int32_t temp24 = readRegister24(MAX31856_LTCBH_REG);
+float Adafruit_MAX31856::decodeThermocoupleTemperature(const uint8_t buffer[3]) {
+  int32_t temp24 = ((uint32_t)buffer[0] << 16) | ((uint32_t)buffer[1] << 8) | buffer[2];
   if (temp24 & 0x800000) {
     temp24 |= 0xFF000000;  // fix sign
   }
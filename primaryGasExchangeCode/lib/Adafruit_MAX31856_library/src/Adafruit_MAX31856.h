@@ -55,12 +55,30 @@
 #define MAX31856_FAULT_OVUV        0x02    ///< Fault status Overvoltage or Undervoltage Input Fault flag
 #define MAX31856_FAULT_OPEN        0x01    ///< Fault status Thermocouple Open-Circuit Fault flag
 
+#define MAX31856_CR1_AVGSEL_MASK   0x70    ///< Config 1 averaging mode bits
+
 /** Noise filtering options enum. Use with setNoiseFilter() */
 typedef enum {
 MAX31856_NOISE_FILTER_50HZ,
 MAX31856_NOISE_FILTER_60HZ
 } max31856_noise_filter_t;
 
+/** Number of samples averaged per conversion. Use with setAveragingMode() */
+typedef enum {
+  MAX31856_AVERAGE_1_SAMPLE   = 0b000,
+  MAX31856_AVERAGE_2_SAMPLES  = 0b001,
+  MAX31856_AVERAGE_4_SAMPLES  = 0b010,
+  MAX31856_AVERAGE_8_SAMPLES  = 0b011,
+  MAX31856_AVERAGE_16_SAMPLES = 0b100,
+} max31856_averaging_t;
+
+/** Conversion modes. Use with setConversionMode() */
+typedef enum {
+  MAX31856_ONESHOT,        ///< read functions trigger a conversion and wait for it
+  MAX31856_ONESHOT_NOWAIT, ///< triggerOneShot() starts it, read functions only read
+  MAX31856_CONTINUOUS      ///< chip converts on its own, read functions only read
+} max31856_conversion_modes_t;
+
 /** Multiple types of thermocouples supported */
 typedef enum
 {
@@ -83,6 +101,13 @@ typedef enum
  #include "WProgram.h"
 #endif
 
+/** Results of one conversion. Use with readConversion() */
+typedef struct {
+  float coldJunction; ///< Cold junction (chip) temperature in Celsius
+  float thermocouple; ///< Thermocouple tip temperature in Celsius
+  uint8_t fault;      ///< Fault status register, MAX31856_FAULT_* flags
+} max31856_conversion_t;
+
 /**************************************************************************/
 /*! 
     @brief  Class that stores state and functions for interacting with MAX31856
@@ -91,8 +116,8 @@ typedef enum
 
 class Adafruit_MAX31856 {
  public:
-  Adafruit_MAX31856(int8_t spi_cs, int8_t spi_mosi, int8_t spi_miso, int8_t spi_clk);
-  Adafruit_MAX31856(int8_t spi_cs);
+  Adafruit_MAX31856(int8_t spi_cs, int8_t spi_mosi, int8_t spi_miso, int8_t spi_clk, int8_t drdy = -1);
+  Adafruit_MAX31856(int8_t spi_cs, int8_t drdy = -1);
 
   boolean begin(void);
 
@@ -102,18 +127,34 @@ class Adafruit_MAX31856 {
   uint8_t readFault(void);
   void oneShotTemperature(void);
 
+  void setConversionMode(max31856_conversion_modes_t mode);
+  max31856_conversion_modes_t getConversionMode(void);
+  void setAveragingMode(max31856_averaging_t mode);
+  max31856_averaging_t getAveragingMode(void);
+  void triggerOneShot(void);
+  bool conversionComplete(void);
+  uint16_t conversionTime(void);
+
   float readCJTemperature(void);
   float readThermocoupleTemperature(void);
+  bool readConversion(max31856_conversion_t *conversion);
 
   void setTempFaultThreshholds(float flow, float fhigh);
   void setColdJunctionFaultThreshholds(int8_t low, int8_t high);
   void setNoiseFilter(max31856_noise_filter_t noiseFilter);
 
  private:
-  int8_t _sclk, _miso, _mosi, _cs;
+  int8_t _sclk, _miso, _mosi, _cs, _drdy;
+
+  max31856_conversion_modes_t _conversionMode;
+  uint32_t _conversionStart;
+  uint16_t _conversionTime;
 
   void readRegisterN(uint8_t addr, uint8_t buffer[], uint8_t n);
 
+  static float decodeCJTemperature(const uint8_t buffer[2]);
+  static float decodeThermocoupleTemperature(const uint8_t buffer[3]);
+
   uint8_t  readRegister8(uint8_t addr);
   uint16_t readRegister16(uint8_t addr);
   uint32_t readRegister24(uint8_t addr);
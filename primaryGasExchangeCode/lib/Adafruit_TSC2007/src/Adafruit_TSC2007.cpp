@@ -34,6 +34,7 @@
 #include "Arduino.h"
 
 #include "Adafruit_TSC2007.h"
+#include "InstrumentationHooks.h"
 
 /*!
  *    @brief  Instantiates a new TSC2007 class
@@ -72,7 +73,7 @@ bool Adafruit_TSC2007::begin(uint8_t address, TwoWire *wire) {
   }
   
 
-  command(MEASURE_TEMP0, POWERDOWN_IRQON, ADC_12BIT);
+  powerDown();
   return true;
 }
 
@@ -96,8 +97,15 @@ uint16_t Adafruit_TSC2007::command(adafruit_tsc2007_function func,
     return 0;
   }
 
-  // Wait 1/2ms for conversion
-  delayMicroseconds(500);
+  // Wait for conversion, 1/2ms at 12 bits, less for the shorter 8 bit one
+  INSTR_HOOK_DELAY_US(res == ADC_8BIT ? 300 : 500);
+
+  if (res == ADC_8BIT) {
+    if (!i2c_dev->read(reply, 1)) {
+      return 0;
+    }
+    return (uint16_t)reply[0] << 4; // 8 bits, scaled to the 12 bit range
+  }
 
   if (!i2c_dev->read(reply, 2)) {
     return 0;
@@ -106,6 +114,80 @@ uint16_t Adafruit_TSC2007::command(adafruit_tsc2007_function func,
   return ((uint16_t)reply[0] << 4) | (reply[1] >> 4); // 12 bits
 }
 
+/*!
+ *    @brief  Choose how many conversions read_touch() makes
+ *    @param  profile TSC2007_SAMPLE_FAST, TSC2007_SAMPLE_STANDARD or
+ *            TSC2007_SAMPLE_FILTERED
+ *    @param  filterSamples X/Y samples for the filtered profile, up to
+ *            TSC2007_MAX_FILTER_SAMPLES
+ */
+void Adafruit_TSC2007::setSamplingProfile(adafruit_tsc2007_profile profile,
+                                          uint8_t filterSamples) {
+  _profile = profile;
+  if (filterSamples < 1) {
+    filterSamples = 1;
+  }
+  if (filterSamples > TSC2007_MAX_FILTER_SAMPLES) {
+    filterSamples = TSC2007_MAX_FILTER_SAMPLES;
+  }
+  _filterSamples = filterSamples;
+}
+
+/*!
+ *    @brief  Get the sampling profile
+ *    @return The profile set with setSamplingProfile()
+ */
+adafruit_tsc2007_profile Adafruit_TSC2007::getSamplingProfile(void) {
+  return _profile;
+}
+
+/*!
+ *    @brief  Choose the ADC resolution read_touch() uses. Readings stay in
+ *            the 12 bit range either way, so calibration doesn't change.
+ *    @param  res ADC_12BIT or ADC_8BIT
+ */
+void Adafruit_TSC2007::setResolution(adafruit_tsc2007_resolution res) {
+  _resolution = res;
+}
+
+/*!
+ *    @brief  Get the ADC resolution
+ *    @return The resolution set with setResolution()
+ */
+adafruit_tsc2007_resolution Adafruit_TSC2007::getResolution(void) {
+  return _resolution;
+}
+
+uint16_t Adafruit_TSC2007::measure(adafruit_tsc2007_function func) {
+  return command(func, ADON_IRQOFF, _resolution);
+}
+
+uint16_t Adafruit_TSC2007::measureMedian(adafruit_tsc2007_function func) {
+  uint16_t samples[TSC2007_MAX_FILTER_SAMPLES];
+
+  // insertion sort as they come in
+  for (uint8_t i = 0; i < _filterSamples; i++) {
+    uint16_t v = measure(func);
+    int8_t j = i - 1;
+    while (j >= 0 && samples[j] > v) {
+      samples[j + 1] = samples[j];
+      j--;
+    }
+    samples[j + 1] = v;
+  }
+  return samples[_filterSamples / 2];
+}
+
+// Power down with PENIRQ enabled. Only the command byte is needed for that,
+// the TEMP0 result is never used so don't wait for or read it.
+bool Adafruit_TSC2007::powerDown(void) {
+  uint8_t cmd = (uint8_t)MEASURE_TEMP0 << 4;
+  cmd |= (uint8_t)POWERDOWN_IRQON << 2;
+  cmd |= (uint8_t)_resolution << 1;
+
+  return i2c_dev->write(&cmd, 1);
+}
+
 /*!
  *    @brief  Read touch data from the TSC and then power down
  *    @param  x Pointer to 16-bit value we will store x reading
@@ -116,25 +198,42 @@ uint16_t Adafruit_TSC2007::command(adafruit_tsc2007_function func,
  */
 bool Adafruit_TSC2007::read_touch(uint16_t *x, uint16_t *y, uint16_t *z1,
                                   uint16_t *z2) {
-  *z1 = command(MEASURE_Z1, ADON_IRQOFF, ADC_12BIT);
-  *z2 = command(MEASURE_Z2, ADON_IRQOFF, ADC_12BIT);
-  // take two measurements since there can be a 'flicker' on pen up
-  uint16_t x1, y1, x2, y2;
-  x1 = command(MEASURE_X, ADON_IRQOFF, ADC_12BIT);
-  y1 = command(MEASURE_Y, ADON_IRQOFF, ADC_12BIT);
-  x2 = command(MEASURE_X, ADON_IRQOFF, ADC_12BIT);
-  y2 = command(MEASURE_Y, ADON_IRQOFF, ADC_12BIT);
-
-  command(MEASURE_TEMP0, POWERDOWN_IRQON, ADC_12BIT);
-
-  if (abs((int32_t)x1 - (int32_t)x2) > 100)
-    return false;
-  if (abs((int32_t)y1 - (int32_t)y2) > 100)
-    return false;
+  uint16_t x1, y1;
+
+  *z1 = measure(MEASURE_Z1);
+
+  if (_profile == TSC2007_SAMPLE_FAST) {
+    *z2 = 0;
+    x1 = measure(MEASURE_X);
+    y1 = measure(MEASURE_Y);
+  } else if (_profile == TSC2007_SAMPLE_FILTERED) {
+    *z2 = measure(MEASURE_Z2);
+    x1 = measureMedian(MEASURE_X);
+    y1 = measureMedian(MEASURE_Y);
+  } else {
+    *z2 = measure(MEASURE_Z2);
+    // take two measurements since there can be a 'flicker' on pen up
+    uint16_t x2, y2;
+    x1 = measure(MEASURE_X);
+    y1 = measure(MEASURE_Y);
+    x2 = measure(MEASURE_X);
+    y2 = measure(MEASURE_Y);
+
+    if (abs((int32_t)x1 - (int32_t)x2) > 100 ||
+        abs((int32_t)y1 - (int32_t)y2) > 100) {
+      powerDown();
+      return false;
+    }
+  }
+
+  powerDown();
+
+  // 8 bit readings top out at 4080 after scaling
+  uint16_t maxReading = (_resolution == ADC_8BIT) ? 0xFF0 : 0xFFF;
 
   *x = x1;
   *y = y1;
-  return (*x != 4095) && (*y != 4095);
+  return (*x != maxReading) && (*y != maxReading);
 }
 
 /*!
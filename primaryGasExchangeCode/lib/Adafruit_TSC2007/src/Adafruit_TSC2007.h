@@ -24,6 +24,7 @@
 #include <Wire.h>
 
 #define TSC2007_I2CADDR_DEFAULT 0x48 ///< TSC2007 default i2c address
+#define TSC2007_MAX_FILTER_SAMPLES 9 ///< Most X/Y samples the filtered profile takes
 
 /*!
  *  @brief  Class for working with points
@@ -75,6 +76,15 @@ typedef enum {
   ADC_8BIT = 1,
 } adafruit_tsc2007_resolution;
 
+/*!
+ *    @brief  How many conversions read_touch() makes per sample
+ */
+typedef enum {
+  TSC2007_SAMPLE_FAST,     ///< Z1, X and Y once
+  TSC2007_SAMPLE_STANDARD, ///< Z1, Z2, then X and Y twice to catch pen-up flicker
+  TSC2007_SAMPLE_FILTERED, ///< Z1, Z2, then the median of N X and Y samples
+} adafruit_tsc2007_profile;
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            the TSC2007 driver
@@ -92,8 +102,22 @@ public:
 
   TS_Point getPoint();
 
+  void setSamplingProfile(adafruit_tsc2007_profile profile,
+                          uint8_t filterSamples = 5);
+  adafruit_tsc2007_profile getSamplingProfile(void);
+  void setResolution(adafruit_tsc2007_resolution res);
+  adafruit_tsc2007_resolution getResolution(void);
+
 private:
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
+
+  adafruit_tsc2007_profile _profile = TSC2007_SAMPLE_STANDARD;
+  adafruit_tsc2007_resolution _resolution = ADC_12BIT;
+  uint8_t _filterSamples = 5;
+
+  uint16_t measure(adafruit_tsc2007_function func);
+  uint16_t measureMedian(adafruit_tsc2007_function func);
+  bool powerDown(void);
 };
 
 #endif
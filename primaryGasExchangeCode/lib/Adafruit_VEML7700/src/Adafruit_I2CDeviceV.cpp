@@ -1,4 +1,5 @@
 
+#include "InstrumentationHooks.h"
 #include "Adafruit_I2CDeviceV.h"
 
 //#define DEBUG_SERIAL Serial
@@ -31,6 +32,7 @@ bool Adafruit_I2CDevice_::detected(void) {
 }
 
 bool Adafruit_I2CDevice_::write(uint8_t *buffer, size_t len, bool stop, uint8_t *prefix_buffer, size_t prefix_len) {
+  INSTR_HOOK_SPAN(INSTR_HOOK_I2C, len + prefix_len);
   if ((len+prefix_len) > 32) {
     // currently not guaranteed to work if more than 32 bytes!
     // we will need to find out if some platforms have larger
@@ -86,6 +88,7 @@ bool Adafruit_I2CDevice_::write(uint8_t *buffer, size_t len, bool stop, uint8_t
 }
 
 bool Adafruit_I2CDevice_::read(uint8_t *buffer, size_t len, bool stop) {
+  INSTR_HOOK_SPAN(INSTR_HOOK_I2C, len);
   if (len > 32) {
     // currently not guaranteed to work if more than 32 bytes!
     // we will need to find out if some platforms have larger
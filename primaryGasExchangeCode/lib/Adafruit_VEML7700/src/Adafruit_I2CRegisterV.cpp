@@ -9,11 +9,23 @@ Adafruit_I2CRegister_::Adafruit_I2CRegister_(Adafruit_I2CDevice_ *device, uint16
   _address = reg_addr;
   _bitorder = bitorder;
   _width = width;
+  _shadowed = false;
+  _shadowValid = false;
+  _shadow = 0;
+}
+
+// A shadowed register keeps a copy of its value so read() and the read-modify-write in
+// Adafruit_I2CRegisterBits_ don't go to the bus. Only use it for registers the chip never
+// changes on its own (configuration, not data or status).
+void Adafruit_I2CRegister_::setShadowed(bool shadowed) {
+  _shadowed = shadowed;
+  _shadowValid = false;
 }
 
 
 bool Adafruit_I2CRegister_::write(uint8_t *buffer, uint8_t len) {
   uint8_t addrbuffer[2] = {(uint8_t)(_address & 0xFF), (uint8_t)(_address>>8)};
+  _shadowValid = false;
   if (! _device->write(buffer, len, true, addrbuffer, _addrwidth)) {
     return false;
   }
@@ -27,6 +39,7 @@ bool Adafruit_I2CRegister_::write(uint32_t value, uint8_t numbytes) {
   if (numbytes > 4) {
     return false;
   }
+  uint32_t shadowValue = value;
 
   for (int i=0; i<numbytes; i++) {
     if (_bitorder == LSBFIRST) {
@@ -36,11 +49,21 @@ bool Adafruit_I2CRegister_::write(uint32_t value, uint8_t numbytes) {
     }
     value >>= 8;
   }
-  return write(_buffer, numbytes);
+  if (! write(_buffer, numbytes)) {
+    return false;
+  }
+  if (_shadowed && numbytes == _width) {
+    _shadow = shadowValue;
+    _shadowValid = true;
+  }
+  return true;
 }
 
 // This does not do any error checking! returns 0xFFFFFFFF on failure
 uint32_t Adafruit_I2CRegister_::read(void) {
+  if (_shadowed && _shadowValid) {
+    return _shadow;
+  }
   if (! read(_buffer, _width)) {
     return -1;
   }
@@ -56,6 +79,10 @@ uint32_t Adafruit_I2CRegister_::read(void) {
      }
    }
 
+   if (_shadowed) {
+     _shadow = value;
+     _shadowValid = true;
+   }
    return value;
 }
 
@@ -114,14 +141,14 @@ Adafruit_I2CRegisterBits_::Adafruit_I2CRegisterBits_(Adafruit_I2CRegister_ *reg,
 uint32_t Adafruit_I2CRegisterBits_::read(void) {
   uint32_t val = _register->read();
   val >>= _shift;
-  return val & ((1 << (_bits+1)) - 1);
+  return val & ((1 << _bits) - 1);
 }
 
 void Adafruit_I2CRegisterBits_::write(uint32_t data) {
   uint32_t val = _register->read();
 
   // mask off the data before writing
-  uint32_t mask = (1 << (_bits+1)) - 1;
+  uint32_t mask = (1 << _bits) - 1;
   data &= mask;
 
   mask <<= _shift;
@@ -20,6 +20,8 @@ public:
 
   uint8_t width(void) { return _width; }
 
+  void setShadowed(bool shadowed);
+
   void print(Stream *s = &Serial);
   void println(Stream *s = &Serial);
 
@@ -28,6 +30,8 @@ private:
   uint16_t _address;
   uint8_t _width, _addrwidth, _bitorder;
   uint8_t _buffer[4]; // we wont support anything larger than uint32 for non-buffered read
+  bool _shadowed, _shadowValid;
+  uint32_t _shadow; // last value written to / read from a shadowed register
 };
 
 class Adafruit_I2CRegisterBits_
@@ -29,10 +29,28 @@
 
 #include "Adafruit_VEML7700.h"
 
+// Auto range ladder, least to most sensitive. Gain goes up before integration
+// time does, so every light level gets the shortest integration time that
+// still gives VEML7700_AUTO_LOW_COUNTS worth of resolution.
+static const uint8_t autoRangeGain[] = {
+    VEML7700_GAIN_1_8, VEML7700_GAIN_1_4, VEML7700_GAIN_1, VEML7700_GAIN_2,
+    VEML7700_GAIN_2,   VEML7700_GAIN_2,   VEML7700_GAIN_2, VEML7700_GAIN_2,
+    VEML7700_GAIN_2};
+static const uint8_t autoRangeIT[] = {
+    VEML7700_IT_25MS,  VEML7700_IT_25MS,  VEML7700_IT_25MS,
+    VEML7700_IT_25MS,  VEML7700_IT_50MS,  VEML7700_IT_100MS,
+    VEML7700_IT_200MS, VEML7700_IT_400MS, VEML7700_IT_800MS};
+// Relative sensitivity of each step (gain x8 times integration time / 25ms)
+static const uint16_t autoRangeSensitivity[] = {1, 2, 8, 16, 32, 64, 128, 256, 512};
+static const uint8_t AUTO_RANGE_STEPS = sizeof(autoRangeSensitivity) / sizeof(autoRangeSensitivity[0]);
+
 /*!
  *    @brief  Instantiates a new VEML7700 class
  */
-Adafruit_VEML7700_::Adafruit_VEML7700_(void) {}
+Adafruit_VEML7700_::Adafruit_VEML7700_(void) {
+  rangeChangeTime = 0;
+  rangeSettleTime = 0;
+}
 
 /*!
  *    @brief  Setups the hardware for talking to the VEML7700
@@ -56,6 +74,12 @@ boolean Adafruit_VEML7700_::begin(TwoWire *theWire)
   White_Data = new Adafruit_I2CRegister_(i2c_dev, VEML7700_WHITE_DATA, 2, LSBFIRST);
   Interrupt_Status = new Adafruit_I2CRegister_(i2c_dev, VEML7700_INTERRUPTSTATUS, 2, LSBFIRST);
 
+  // Config registers only change when we write them, so keep a copy on our side.
+  // getGain()/getIntegrationTime() in normalize() then cost no I2C traffic and
+  // readLux()/readWhite() are a single register read.
+  ALS_Config->setShadowed(true);
+  Power_Saving->setShadowed(true);
+
   ALS_Shutdown = new Adafruit_I2CRegisterBits_(ALS_Config, 1, 0); // # bits, bit_shift
   ALS_Interrupt_Enable = new Adafruit_I2CRegisterBits_(ALS_Config, 1, 1);
   ALS_Persistence = new Adafruit_I2CRegisterBits_(ALS_Config, 2, 4);
@@ -75,6 +99,12 @@ boolean Adafruit_VEML7700_::begin(TwoWire *theWire)
   return true;
 }
 
+/*!
+ *    @brief Scale a raw count to 1x gain and 100ms integration time, using
+ *    the shadowed config register
+ *    @param value Raw ALS or white count
+ *    @returns Normalized count
+ */
 float Adafruit_VEML7700_::normalize(float value)
 {
   // adjust for gain (1x is normalized)
@@ -123,6 +153,110 @@ float Adafruit_VEML7700_::readLux()
   return normalize(ALS_Data->read()) * 0.0576; // see app note lux table on page 5
 }
 
+/*!
+ *    @brief Read lux and pick the gain/integration time for the next sample
+ *    from this ALS count. Never waits: right after a range switch it returns
+ *    false until one integration with the new setting has completed.
+ *    @param sample Filled with the lux value and the setting that produced it
+ *    @returns True if sample holds a fresh reading
+ */
+bool Adafruit_VEML7700_::readLuxAuto(veml7700_sample_t *sample)
+{
+  if ((millis() - rangeChangeTime) < rangeSettleTime)
+  {
+    return false;
+  }
+
+  uint16_t als = ALS_Data->read();
+  sample->als = als;
+  sample->gain = getGain();
+  sample->integrationTime = getIntegrationTime();
+
+  float lux = normalize(als) * 0.0576;
+  if (lux > 1000)
+  {
+    // nonlinearity correction from the "Designing the VEML7700 Into an Application" app note
+    lux = (((6.0135e-13 * lux - 9.3924e-9) * lux + 8.1488e-5) * lux + 1.0023) * lux;
+  }
+  sample->lux = lux;
+
+  // Find where the current range sits in the ladder, the config may have been
+  // changed with setGain()/setIntegrationTime() since the last call
+  uint8_t current = AUTO_RANGE_STEPS;
+  for (uint8_t i = 0; i < AUTO_RANGE_STEPS; i++)
+  {
+    if (autoRangeGain[i] == sample->gain && autoRangeIT[i] == sample->integrationTime)
+    {
+      current = i;
+      break;
+    }
+  }
+
+  if (current == AUTO_RANGE_STEPS || als == 0xFFFF)
+  {
+    setRange(0); // off the ladder or saturated: restart from the least sensitive step
+  }
+  else if (als < VEML7700_AUTO_LOW_COUNTS || als > VEML7700_AUTO_HIGH_COUNTS)
+  {
+    // least sensitive step whose predicted count is usable
+    uint8_t next = AUTO_RANGE_STEPS - 1;
+    for (uint8_t i = 0; i < AUTO_RANGE_STEPS; i++)
+    {
+      uint32_t predicted = (uint32_t)als * autoRangeSensitivity[i] / autoRangeSensitivity[current];
+      if (predicted >= VEML7700_AUTO_LOW_COUNTS)
+      {
+        next = i;
+        break;
+      }
+    }
+    if (next != current)
+    {
+      setRange(next);
+    }
+  }
+  return true;
+}
+
+/*!
+ *    @brief Switch to one step of the auto range ladder
+ *    @param range Ladder index, 0 is the least sensitive
+ */
+void Adafruit_VEML7700_::setRange(uint8_t range)
+{
+  uint16_t previousIT = integrationTimeMs(getIntegrationTime());
+
+  setGain(autoRangeGain[range]);
+  setIntegrationTime(autoRangeIT[range]);
+  // the integration in flight finishes with the old setting, then one full new one
+  rangeChangeTime = millis();
+  rangeSettleTime = previousIT + integrationTimeMs(autoRangeIT[range]);
+}
+
+/*!
+ *    @brief Integration time in milliseconds
+ *    @param it VEML7700_IT_* constant
+ *    @returns Integration time in ms
+ */
+uint16_t Adafruit_VEML7700_::integrationTimeMs(uint8_t it)
+{
+  switch (it)
+  {
+  case VEML7700_IT_25MS:
+    return 25;
+  case VEML7700_IT_50MS:
+    return 50;
+  case VEML7700_IT_200MS:
+    return 200;
+  case VEML7700_IT_400MS:
+    return 400;
+  case VEML7700_IT_800MS:
+    return 800;
+  case VEML7700_IT_100MS:
+  default:
+    return 100;
+  }
+}
+
 /*!
  *    @brief Read the raw ALS data
  *    @returns 16-bit data value from the ALS register
@@ -55,6 +55,19 @@
 #define VEML7700_POWERSAVE_MODE3 0x02 ///< Power saving mode 3
 #define VEML7700_POWERSAVE_MODE4 0x03 ///< Power saving mode 4
 
+#define VEML7700_AUTO_LOW_COUNTS 100    ///< Auto range steps up below this ALS count
+#define VEML7700_AUTO_HIGH_COUNTS 10000 ///< Auto range steps down above this ALS count
+
+/*!
+ *    @brief  One auto ranged lux sample and the setting that produced it
+ */
+typedef struct {
+  float lux;               ///< Lux, nonlinearity corrected above 1000 lux
+  uint16_t als;            ///< Raw ALS count
+  uint8_t gain;            ///< VEML7700_GAIN_* used for this sample
+  uint8_t integrationTime; ///< VEML7700_IT_* used for this sample
+} veml7700_sample_t;
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            VEML7700 Lux Sensor
@@ -90,6 +103,9 @@ public:
   float readLux();
   uint16_t readALS();
   float readWhite();
+  bool readLuxAuto(veml7700_sample_t *sample);
+
+  static uint16_t integrationTimeMs(uint8_t it);
 
 private:
   Adafruit_I2CRegister_ *ALS_Config, *ALS_Data, *White_Data,
@@ -99,6 +115,10 @@ private:
       *PowerSave_Enable, *PowerSave_Mode;
 
   float normalize(float value);
+  void setRange(uint8_t range);
+
+  uint32_t rangeChangeTime;   // millis() of the last auto range switch
+  uint16_t rangeSettleTime;   // ms before the data register reflects the new range
 
   Adafruit_I2CDevice_ *i2c_dev;
 };
@@ -0,0 +1,309 @@
+#include "DisplayBenchmark.h"
+
+// 5-6-5 colors, the same on every Adafruit_SPITFT display
+static const uint16_t BLACK = 0x0000;
+static const uint16_t BLUE = 0x001F;
+static const uint16_t RED = 0xF800;
+static const uint16_t GREEN = 0x07E0;
+static const uint16_t CYAN = 0x07FF;
+static const uint16_t MAGENTA = 0xF81F;
+static const uint16_t YELLOW = 0xFFE0;
+static const uint16_t WHITE = 0xFFFF;
+
+/**************************************************************************/
+/*!
+    @brief  The graphics tests from Touchscreen_Display/LargerThanLife. The
+            clears that were kept out of the timing there are the prepare
+            step here, so the four fans of lines are four tests.
+*/
+/**************************************************************************/
+
+static void clearScreen(Adafruit_SPITFT *tft) { tft->fillScreen(BLACK); }
+
+static void testFillScreen(Adafruit_SPITFT *tft) {
+  tft->fillScreen(BLACK);
+  tft->fillScreen(RED);
+  tft->fillScreen(GREEN);
+  tft->fillScreen(BLUE);
+  tft->fillScreen(BLACK);
+}
+
+static void testText(Adafruit_SPITFT *tft) {
+  tft->setCursor(0, 0);
+  tft->setTextColor(WHITE);
+  tft->setTextSize(1);
+  tft->println("Hello World!");
+  tft->setTextColor(YELLOW);
+  tft->setTextSize(2);
+  tft->println(1234.56);
+  tft->setTextColor(RED);
+  tft->setTextSize(3);
+  tft->println(0xDEADBEEF, HEX);
+  tft->println();
+  tft->setTextColor(GREEN);
+  tft->setTextSize(5);
+  tft->println("Groop");
+  tft->setTextSize(2);
+  tft->println("I implore thee,");
+  tft->setTextSize(1);
+  tft->println("my foonting turlingdromes.");
+  tft->println("And hooptiously drangle me");
+  tft->println("with crinkly bindlewurdles,");
+  tft->println("Or I will rend thee");
+  tft->println("in the gobberwarts");
+  tft->println("with my blurglecruncheon,");
+  tft->println("see if I don't!");
+}
+
+// One fan of lines from a corner to the far edges. The original clears the
+// screen before each of the four fans and keeps the clears out of the timing,
+// so each fan is its own test here.
+static void testLines(Adafruit_SPITFT *tft, int x1, int y1) {
+  int x2, y2, w = tft->width(), h = tft->height();
+
+  y2 = h - 1 - y1;
+  for (x2 = 0; x2 < w; x2 += 6)
+    tft->drawLine(x1, y1, x2, y2, CYAN);
+  x2 = w - 1 - x1;
+  for (y2 = 0; y2 < h; y2 += 6)
+    tft->drawLine(x1, y1, x2, y2, CYAN);
+}
+
+static void testLinesTopLeft(Adafruit_SPITFT *tft) { testLines(tft, 0, 0); }
+
+static void testLinesTopRight(Adafruit_SPITFT *tft) {
+  testLines(tft, tft->width() - 1, 0);
+}
+
+static void testLinesBottomLeft(Adafruit_SPITFT *tft) {
+  testLines(tft, 0, tft->height() - 1);
+}
+
+static void testLinesBottomRight(Adafruit_SPITFT *tft) {
+  testLines(tft, tft->width() - 1, tft->height() - 1);
+}
+
+static void testFastLines(Adafruit_SPITFT *tft) {
+  int x, y, w = tft->width(), h = tft->height();
+
+  for (y = 0; y < h; y += 5)
+    tft->drawFastHLine(0, y, w, RED);
+  for (x = 0; x < w; x += 5)
+    tft->drawFastVLine(x, 0, h, BLUE);
+}
+
+static void testRects(Adafruit_SPITFT *tft) {
+  int n, i, i2, cx = tft->width() / 2, cy = tft->height() / 2;
+
+  n = min(tft->width(), tft->height());
+  for (i = 2; i < n; i += 6) {
+    i2 = i / 2;
+    tft->drawRect(cx - i2, cy - i2, i, i, GREEN);
+  }
+}
+
+static void testFilledRects(Adafruit_SPITFT *tft) {
+  int n, i, i2, cx = tft->width() / 2 - 1, cy = tft->height() / 2 - 1;
+
+  n = min(tft->width(), tft->height());
+  for (i = n; i > 0; i -= 6) {
+    i2 = i / 2;
+    tft->fillRect(cx - i2, cy - i2, i, i, YELLOW);
+  }
+}
+
+static void testFilledCircles(Adafruit_SPITFT *tft) {
+  int x, y, w = tft->width(), h = tft->height(), radius = 10, r2 = 20;
+
+  for (x = radius; x < w; x += r2) {
+    for (y = radius; y < h; y += r2) {
+      tft->fillCircle(x, y, radius, MAGENTA);
+    }
+  }
+}
+
+// Not cleared first, on purpose (same as the original)
+static void testCircles(Adafruit_SPITFT *tft) {
+  int x, y, radius = 10, r2 = 20, w = tft->width() + radius,
+            h = tft->height() + radius;
+
+  for (x = 0; x < w; x += r2) {
+    for (y = 0; y < h; y += r2) {
+      tft->drawCircle(x, y, radius, WHITE);
+    }
+  }
+}
+
+static void testTriangles(Adafruit_SPITFT *tft) {
+  int n, i, cx = tft->width() / 2 - 1, cy = tft->height() / 2 - 1;
+
+  n = min(cx, cy);
+  for (i = 0; i < n; i += 5) {
+    tft->drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
+                      tft->color565(i, i, i));
+  }
+}
+
+static void testFilledTriangles(Adafruit_SPITFT *tft) {
+  int i, cx = tft->width() / 2 - 1, cy = tft->height() / 2 - 1;
+
+  for (i = min(cx, cy); i > 10; i -= 5) {
+    tft->fillTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
+                      tft->color565(0, i * 10, i * 10));
+  }
+}
+
+static void testRoundRects(Adafruit_SPITFT *tft) {
+  int w, i, i2, cx = tft->width() / 2 - 1, cy = tft->height() / 2 - 1;
+
+  w = min(tft->width(), tft->height());
+  for (i = 0; i < w; i += 6) {
+    i2 = i / 2;
+    tft->drawRoundRect(cx - i2, cy - i2, i, i, i / 8, tft->color565(i, 0, 0));
+  }
+}
+
+static void testFilledRoundRects(Adafruit_SPITFT *tft) {
+  int i, i2, cx = tft->width() / 2 - 1, cy = tft->height() / 2 - 1;
+
+  for (i = min(tft->width(), tft->height()); i > 20; i -= 6) {
+    i2 = i / 2;
+    tft->fillRoundRect(cx - i2, cy - i2, i, i, i / 8, tft->color565(0, i, 0));
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Create a benchmark for one display
+    @param  tft  The display, already begun
+    @param  out  Where the report goes
+*/
+/**************************************************************************/
+DisplayBenchmark::DisplayBenchmark(Adafruit_SPITFT *tft, Print *out) {
+  _tft = tft;
+  _out = out;
+  _count = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Append a test
+    @param  name  Printed in the report
+    @param  run  Timed drawing
+    @param  prepare  Untimed setup before run, or NULL
+    @returns False if the list is full
+*/
+/**************************************************************************/
+bool DisplayBenchmark::add(const char *name, void (*run)(Adafruit_SPITFT *tft),
+                           void (*prepare)(Adafruit_SPITFT *tft)) {
+  if (_count >= BENCH_MAX_TESTS) {
+    return false;
+  }
+  _tests[_count].name = name;
+  _tests[_count].prepare = prepare;
+  _tests[_count].run = run;
+  _count++;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Append the LargerThanLife graphics tests
+*/
+/**************************************************************************/
+void DisplayBenchmark::addStandardSuite() {
+  add("Screen fill", testFillScreen);
+  add("Text", testText, clearScreen);
+  add("Lines (top left)", testLinesTopLeft, clearScreen);
+  add("Lines (top right)", testLinesTopRight, clearScreen);
+  add("Lines (bottom left)", testLinesBottomLeft, clearScreen);
+  add("Lines (bottom right)", testLinesBottomRight, clearScreen);
+  add("Horiz/Vert Lines", testFastLines, clearScreen);
+  add("Rectangles (outline)", testRects, clearScreen);
+  add("Rectangles (filled)", testFilledRects, clearScreen);
+  add("Circles (filled)", testFilledCircles, clearScreen);
+  add("Circles (outline)", testCircles);
+  add("Triangles (outline)", testTriangles, clearScreen);
+  add("Triangles (filled)", testFilledTriangles, clearScreen);
+  add("Rounded rects (outline)", testRoundRects, clearScreen);
+  add("Rounded rects (filled)", testFilledRoundRects, clearScreen);
+}
+
+/**************************************************************************/
+/*!
+    @brief  A test added earlier, e.g. to measure() it alone
+    @param  index  0 for the first one added
+    @returns The test, or NULL past the end of the list
+*/
+/**************************************************************************/
+const bench_test_t *DisplayBenchmark::test(int index) const {
+  if (index < 0 || index >= _count) {
+    return NULL;
+  }
+  return &_tests[index];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Run one test. Any DMA still going after prepare is finished
+            before the clock starts, and the last DMA of run is waited for
+            before it stops.
+    @param  test  The test
+    @returns Time, pixels and bytes of the run step
+*/
+/**************************************************************************/
+bench_result_t DisplayBenchmark::measure(const bench_test_t *test) {
+  bench_result_t result;
+  uint32_t start;
+
+  if (test->prepare) {
+    test->prepare(_tft);
+  }
+  _tft->dmaWait();
+#if defined(SPITFT_STATS)
+  _tft->resetStats();
+#endif
+  start = micros();
+  test->run(_tft);
+  _tft->dmaWait();
+  result.micros = micros() - start;
+#if defined(SPITFT_STATS)
+  result.pixels = _tft->statPixels;
+  result.bytes = _tft->statBytes;
+#else
+  result.pixels = 0;
+  result.bytes = 0;
+#endif
+  return result;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Run every test in order and print the report
+*/
+/**************************************************************************/
+void DisplayBenchmark::run() {
+  bench_result_t result;
+
+  _out->println(F("Benchmark                      us     pixels/s      bytes/s"));
+  for (int i = 0; i < _count; i++) {
+    result = measure(&_tests[i]);
+    report(_tests[i].name, &result);
+    Particle.process();
+  }
+  _out->println(F("Done!"));
+}
+
+void DisplayBenchmark::report(const char *name, const bench_result_t *result) {
+  uint32_t us = result->micros ? result->micros : 1;
+
+#if defined(SPITFT_STATS)
+  _out->printf("%-24s %9lu %12lu %12lu\n", name, (unsigned long)result->micros,
+               (unsigned long)((uint64_t)result->pixels * 1000000 / us),
+               (unsigned long)((uint64_t)result->bytes * 1000000 / us));
+#else
+  (void)us;
+  _out->printf("%-24s %9lu %12s %12s\n", name, (unsigned long)result->micros,
+               "-", "-");
+#endif
+}
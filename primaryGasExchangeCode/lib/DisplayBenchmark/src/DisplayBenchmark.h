@@ -0,0 +1,53 @@
+#ifndef _DISPLAYBENCHMARK_H_
+#define _DISPLAYBENCHMARK_H_
+
+#include "Particle.h"
+#include <Adafruit_SPITFT.h>
+
+#define BENCH_MAX_TESTS 20 ///< Standard suite is 15, leaves room for app tests
+
+/**
+ * @brief One benchmark test. prepare (optional) runs untimed, then run is
+ * timed on its own.
+ */
+typedef struct {
+  const char *name;                      ///< Printed in the report
+  void (*prepare)(Adafruit_SPITFT *tft); ///< Untimed setup, may be NULL
+  void (*run)(Adafruit_SPITFT *tft);     ///< The drawing being measured
+} bench_test_t;
+
+/**
+ * @brief Result of one test.
+ */
+typedef struct {
+  uint32_t micros; ///< Time spent in run(), DMA included
+  uint32_t pixels; ///< Pixels written (0 without SPITFT_STATS)
+  uint32_t bytes;  ///< Bytes sent on SPI (0 without SPITFT_STATS)
+} bench_result_t;
+
+/**
+ * @brief Times a list of drawing tests on an Adafruit_SPITFT display and
+ * prints microseconds, pixels/s and bytes/s for each.
+ */
+class DisplayBenchmark {
+public:
+  DisplayBenchmark(Adafruit_SPITFT *tft, Print *out = &Serial);
+
+  bool add(const char *name, void (*run)(Adafruit_SPITFT *tft),
+           void (*prepare)(Adafruit_SPITFT *tft) = NULL);
+  void addStandardSuite();
+  int count() const { return _count; }
+  const bench_test_t *test(int index) const;
+  bench_result_t measure(const bench_test_t *test);
+  void run();
+
+private:
+  void report(const char *name, const bench_result_t *result);
+
+  Adafruit_SPITFT *_tft;
+  Print *_out;
+  bench_test_t _tests[BENCH_MAX_TESTS];
+  int _count;
+};
+
+#endif // _DISPLAYBENCHMARK_H_
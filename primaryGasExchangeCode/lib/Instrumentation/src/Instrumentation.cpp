@@ -0,0 +1,171 @@
+#include "Instrumentation.h"
+
+#if defined(INSTRUMENTATION)
+
+static const char *PHASE_NAMES[INSTR_PHASES] = {
+  "loop", "delay", "i2c", "spi", "tft", "touch", "hdc", "co2", "lux", "leaf", "redraw"
+};
+
+instr_span_t Instrumentation::_ring[INSTR_RING_SIZE];
+uint16_t Instrumentation::_head = 0;
+instr_stats_t Instrumentation::_stats[INSTR_PHASES];
+uint32_t Instrumentation::_windowStart = 0;
+
+void Instrumentation::record(instr_phase_t phase, uint32_t start, uint32_t micros, uint32_t bytes) {
+  instr_stats_t *stats = &_stats[phase];
+  instr_span_t *span = &_ring[_head];
+  int bucket = 0;
+
+  span->start = start;
+  span->micros = micros;
+  span->bytes = (bytes > 0xFFFF) ? 0xFFFF : bytes;
+  span->phase = phase;
+  _head = (_head + 1) & (INSTR_RING_SIZE - 1);
+
+  while(bucket < INSTR_BUCKETS - 1 && (micros >> bucket) != 0) {
+    bucket++;
+  }
+  if(stats->histogram[bucket] != 0xFFFF) {
+    stats->histogram[bucket]++;
+  }
+  stats->count++;
+  stats->totalMicros += micros;
+  stats->bytes += bytes;
+  if(micros > stats->maxMicros) {
+    stats->maxMicros = micros;
+  }
+}
+
+// For spans that open and close in different functions. Only the outermost pair is timed.
+void Instrumentation::start(instr_phase_t phase) {
+  if(_stats[phase].depth++ == 0) {
+    _stats[phase].started = micros();
+  }
+}
+
+void Instrumentation::stop(instr_phase_t phase, uint32_t bytes) {
+  instr_stats_t *stats = &_stats[phase];
+
+  if(stats->depth == 0 || --stats->depth != 0) {
+    return;
+  }
+  record(phase, stats->started, micros() - stats->started, bytes + stats->pending);
+  stats->pending = 0;
+}
+
+// Bytes for the open span, e.g. each SPI write between startWrite() and endWrite(). With no
+// span open they only go into the totals.
+void Instrumentation::addBytes(instr_phase_t phase, uint32_t bytes) {
+  if(_stats[phase].depth != 0) {
+    _stats[phase].pending += bytes;
+  }
+  else {
+    _stats[phase].bytes += bytes;
+  }
+}
+
+// The driver probes, see InstrumentationHooks.h
+void instrHookStart(instr_hook_t hook) {
+  Instrumentation::start((instr_phase_t)hook);
+}
+
+void instrHookStop(instr_hook_t hook) {
+  Instrumentation::stop((instr_phase_t)hook, 0);
+}
+
+void instrHookBytes(instr_hook_t hook, size_t bytes) {
+  Instrumentation::addBytes((instr_phase_t)hook, bytes);
+}
+
+void Instrumentation::reset() {
+  int i;
+
+  for(i = 0; i < INSTR_PHASES; i++) {
+    uint8_t depth = _stats[i].depth;
+    uint32_t started = _stats[i].started;
+    uint32_t pending = _stats[i].pending;
+
+    memset(&_stats[i], 0, sizeof(_stats[i]));
+    _stats[i].depth = depth; // a span may be open right now
+    _stats[i].started = started;
+    _stats[i].pending = pending;
+  }
+  memset(_ring, 0, sizeof(_ring));
+  _head = 0;
+  _windowStart = millis();
+}
+
+// Upper edge of the histogram bucket holding the given fraction, never above the real max
+uint32_t Instrumentation::percentile(instr_phase_t phase, uint32_t perMille) {
+  instr_stats_t *stats = &_stats[phase];
+  uint32_t seen = 0, total = 0, edge;
+  int bucket;
+
+  for(bucket = 0; bucket < INSTR_BUCKETS; bucket++) {
+    total += stats->histogram[bucket];
+  }
+  for(bucket = 0; bucket < INSTR_BUCKETS; bucket++) {
+    seen += stats->histogram[bucket];
+    if(seen * 1000 >= total * perMille) {
+      break;
+    }
+  }
+  edge = (bucket == 0) ? 0 : (1UL << bucket) - 1;
+  return (edge < stats->maxMicros) ? edge : stats->maxMicros;
+}
+
+// CSV, one line per phase that saw any span. bytes_per_s is over the whole window.
+void Instrumentation::dumpStats(Print *out) {
+  uint32_t window = millis() - _windowStart;
+  int i;
+
+  out->printf("# window_ms,%lu\n", (unsigned long)window);
+  out->printf("phase,count,total_us,max_us,p99_us,bytes,bytes_per_s\n");
+  for(i = 0; i < INSTR_PHASES; i++) {
+    if(_stats[i].count == 0) {
+      continue;
+    }
+    out->printf("%s,%lu,%llu,%lu,%lu,%lu,%lu\n", PHASE_NAMES[i], (unsigned long)_stats[i].count,
+                (unsigned long long)_stats[i].totalMicros, (unsigned long)_stats[i].maxMicros,
+                (unsigned long)percentile((instr_phase_t)i, 990), (unsigned long)_stats[i].bytes,
+                (unsigned long)(window ? (uint64_t)_stats[i].bytes * 1000 / window : 0));
+  }
+}
+
+// CSV of the ring, oldest first
+void Instrumentation::dumpSpans(Print *out) {
+  instr_span_t *span;
+  int i;
+
+  out->printf("start_us,phase,us,bytes\n");
+  for(i = 0; i < INSTR_RING_SIZE; i++) {
+    span = &_ring[(_head + i) & (INSTR_RING_SIZE - 1)];
+    if(span->micros == 0 && span->start == 0) {
+      continue;
+    }
+    out->printf("%lu,%s,%lu,%u\n", (unsigned long)span->start, PHASE_NAMES[span->phase],
+                (unsigned long)span->micros, span->bytes);
+  }
+}
+
+// One letter commands read from in: s = stats, r = recent spans, z = start a new window. The
+// dumps go to out, which mustn't be a port that carries binary frames.
+void Instrumentation::poll(Stream *in, Print *out) {
+  while(in->available() > 0) {
+    switch(in->read()) {
+      case 's':
+        dumpStats(out);
+        break;
+      case 'r':
+        dumpSpans(out);
+        break;
+      case 'z':
+        reset();
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+#endif // INSTRUMENTATION
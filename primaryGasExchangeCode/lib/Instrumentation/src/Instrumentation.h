@@ -0,0 +1,108 @@
+#ifndef _INSTRUMENTATION_H_
+#define _INSTRUMENTATION_H_
+
+// The switch is INSTRUMENTATION in InstrumentationHooks.h, so the drivers see the same
+// setting. Without it every INSTR_ macro below is empty and the firmware compiles to exactly
+// what it was before.
+#include "Particle.h"
+#include "InstrumentationHooks.h"
+
+// What a span measured. Spans nest (an I2C read inside a sensor update), each phase counts its
+// own inclusive time. The driver probes from InstrumentationHooks.h land in the phase with
+// the same number.
+enum instr_phase_t {
+  INSTR_LOOP,                         // one loop() pass
+  INSTR_BLOCKED = INSTR_HOOK_BLOCKED, // drivers in delay()/delayMicroseconds()
+  INSTR_I2C = INSTR_HOOK_I2C,         // Adafruit_I2CDevice and the VEML7700's Adafruit_I2CDevice_
+  INSTR_SPI = INSTR_HOOK_SPI,         // Adafruit_SPIDevice transfers; the bytes include Adafruit_SPITFT's
+  INSTR_TFT = INSTR_HOOK_TFT,         // Adafruit_SPITFT startWrite..endWrite, with the bytes it sent
+  INSTR_TOUCH,
+  INSTR_HDC,
+  INSTR_CO2,
+  INSTR_LUX,
+  INSTR_LEAF,
+  INSTR_REDRAW,
+  INSTR_PHASES
+};
+
+#if defined(INSTRUMENTATION)
+
+const int INSTR_RING_SIZE = 128; // last spans kept, power of two
+const int INSTR_BUCKETS = 24;    // bucket b counts spans of 2^(b-1)..2^b-1 us, the last one everything longer
+
+struct instr_span_t {
+  uint32_t start;  // micros() at the start
+  uint32_t micros;
+  uint16_t bytes;
+  uint8_t phase;
+};
+
+struct instr_stats_t {
+  uint32_t count;
+  uint32_t maxMicros;
+  uint64_t totalMicros;
+  uint32_t bytes;
+  uint16_t histogram[INSTR_BUCKETS];
+  uint8_t depth;    // start()/stop() nesting
+  uint32_t started; // micros() at the outermost start()
+  uint32_t pending; // addBytes() while the span is open, recorded by stop()
+};
+
+// All static, there is one set of numbers for the whole firmware. Not for use from interrupts.
+class Instrumentation {
+
+  static instr_span_t _ring[INSTR_RING_SIZE];
+  static uint16_t _head;
+  static instr_stats_t _stats[INSTR_PHASES];
+  static uint32_t _windowStart;
+
+  static uint32_t percentile(instr_phase_t phase, uint32_t perMille);
+
+  public:
+    static void record(instr_phase_t phase, uint32_t start, uint32_t micros, uint32_t bytes);
+    static void start(instr_phase_t phase);
+    static void stop(instr_phase_t phase, uint32_t bytes);
+    static void addBytes(instr_phase_t phase, uint32_t bytes);
+    static void reset();
+    static const instr_stats_t *stats(instr_phase_t phase) { return &_stats[phase]; }
+    static void dumpStats(Print *out);
+    static void dumpSpans(Print *out);
+    static void poll(Stream *in, Print *out);
+};
+
+// Records the time from construction to the end of the enclosing scope
+class InstrSpan {
+
+  instr_phase_t _phase;
+  uint32_t _start;
+  uint32_t _bytes;
+
+  public:
+    InstrSpan(instr_phase_t phase) {
+      _phase = phase;
+      _bytes = 0;
+      _start = micros();
+    }
+    ~InstrSpan() {
+      Instrumentation::record(_phase, _start, micros() - _start, _bytes);
+    }
+    void addBytes(uint32_t n) { _bytes += n; }
+};
+
+#define INSTR_SPAN(phase) InstrSpan _instrSpan(phase)
+#define INSTR_BYTES(n) _instrSpan.addBytes(n)
+#define INSTR_START(phase) Instrumentation::start(phase)
+#define INSTR_STOP(phase, bytes) Instrumentation::stop(phase, bytes)
+#define INSTR_POLL(in, out) Instrumentation::poll(in, out)
+
+#else
+
+#define INSTR_SPAN(phase)
+#define INSTR_BYTES(n)
+#define INSTR_START(phase)
+#define INSTR_STOP(phase, bytes)
+#define INSTR_POLL(in, out)
+
+#endif // INSTRUMENTATION
+
+#endif // _INSTRUMENTATION_H_
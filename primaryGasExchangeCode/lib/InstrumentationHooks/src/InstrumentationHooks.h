@@ -0,0 +1,63 @@
+#ifndef _INSTRUMENTATIONHOOKS_H_
+#define _INSTRUMENTATIONHOOKS_H_
+
+// Probe points for the drivers in lib/: bus traffic and blocking waits. This is the only
+// instrumentation header a driver includes, it knows nothing about the application.
+//
+// Uncomment to build the probes in. It has to be set here, where every driver and the
+// application see it, not in one source file. Without it the macros below are empty (or a
+// plain delay), so the drivers compile to exactly what they were before.
+// #define INSTRUMENTATION
+
+#include <stdint.h>
+#include <stddef.h>
+
+// What a driver probe measured
+enum instr_hook_t {
+  INSTR_HOOK_BLOCKED = 1, // in delay()/delayMicroseconds() waiting on the part
+  INSTR_HOOK_I2C,         // an I2C read or write
+  INSTR_HOOK_SPI,         // SPI bytes, from any driver
+  INSTR_HOOK_TFT          // an Adafruit_SPITFT startWrite()..endWrite()
+};
+
+#if defined(INSTRUMENTATION)
+
+// Implemented by lib/Instrumentation. Start/stop pairs nest, bytes() adds to the open span of
+// that kind, or straight to its totals when none is open.
+void instrHookStart(instr_hook_t hook);
+void instrHookStop(instr_hook_t hook);
+void instrHookBytes(instr_hook_t hook, size_t bytes);
+
+// Times the enclosing scope
+class InstrHookSpan {
+
+  instr_hook_t _hook;
+
+  public:
+    InstrHookSpan(instr_hook_t hook, size_t bytes) {
+      _hook = hook;
+      instrHookStart(hook);
+      instrHookBytes(hook, bytes);
+    }
+    ~InstrHookSpan() { instrHookStop(_hook); }
+};
+
+#define INSTR_HOOK_SPAN(hook, bytes) InstrHookSpan _instrHookSpan(hook, bytes)
+#define INSTR_HOOK_START(hook) instrHookStart(hook)
+#define INSTR_HOOK_STOP(hook) instrHookStop(hook)
+#define INSTR_HOOK_BYTES(hook, bytes) instrHookBytes(hook, bytes)
+#define INSTR_HOOK_DELAY(ms) do { instrHookStart(INSTR_HOOK_BLOCKED); delay(ms); instrHookStop(INSTR_HOOK_BLOCKED); } while(0)
+#define INSTR_HOOK_DELAY_US(us) do { instrHookStart(INSTR_HOOK_BLOCKED); delayMicroseconds(us); instrHookStop(INSTR_HOOK_BLOCKED); } while(0)
+
+#else
+
+#define INSTR_HOOK_SPAN(hook, bytes)
+#define INSTR_HOOK_START(hook)
+#define INSTR_HOOK_STOP(hook)
+#define INSTR_HOOK_BYTES(hook, bytes)
+#define INSTR_HOOK_DELAY(ms) delay(ms)
+#define INSTR_HOOK_DELAY_US(us) delayMicroseconds(us)
+
+#endif // INSTRUMENTATION
+
+#endif // _INSTRUMENTATIONHOOKS_H_
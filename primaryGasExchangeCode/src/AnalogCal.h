@@ -0,0 +1,56 @@
+#ifndef _ANALOGCAL_H_
+#define _ANALOGCAL_H_
+
+#include "Particle.h"
+#include "AnalogSampler.h"
+
+constexpr double ADC_VREF = 3.3;     // volts at full scale
+constexpr int ADC_FULL_SCALE = 4095;  // 12-bit counts
+
+// Straight line conversion from an AnalogSampler window sum to thousandths of the sensor's unit
+// (milli-ppm, milli-degC), all in integer math:
+//
+//   milli = ((sum * gain) >> 24) + offset
+//
+// gain folds volts per count, the window length and units per volt into one Q24 factor, and is
+// worked out by the compiler from the sensor's datasheet line. At run time a reading is one
+// 32x32->64 multiply, a shift and an add, no float divides.
+struct AnalogCal {
+  int32_t gain;    // Q24, milli-units per window sum count
+  int32_t offset;  // milli-units
+};
+
+// units = (volts - zeroVolts) * unitsPerVolt
+constexpr AnalogCal analogCal(double unitsPerVolt, double zeroVolts) {
+  return AnalogCal{
+    (int32_t)(1000.0 * unitsPerVolt * ADC_VREF / ADC_FULL_SCALE / ADC_WINDOW * 16777216.0 + 0.5),
+    (int32_t)(-1000.0 * zeroVolts * unitsPerVolt + ((zeroVolts * unitsPerVolt > 0) ? -0.5 : 0.5))
+  };
+}
+
+// Applies a per-channel trim on top of the datasheet line: the gain error as a multiplier
+// (1.0 = none) and an offset in thousandths of the unit. Meant for setup or calibration time.
+constexpr AnalogCal analogTrim(AnalogCal base, double gainTrim, int32_t offsetMilli) {
+  return AnalogCal{
+    (int32_t)(base.gain * gainTrim + 0.5),
+    (int32_t)(base.offset * gainTrim + ((base.offset < 0) ? -0.5 : 0.5)) + offsetMilli
+  };
+}
+
+constexpr int32_t analogToMilli(AnalogCal cal, uint32_t sum) {
+  return (int32_t)(((int64_t)sum * cal.gain + 0x800000) >> 24) + cal.offset;
+}
+
+// LI-COR analog output, 0-5V for 0-2000ppm
+constexpr AnalogCal CO2_CAL = analogCal(2000.0 / 5.0, 0.0);
+// Thermocouple amplifier, 1.25V at 0C and 5mV/C
+constexpr AnalogCal LEAF_TEMP_CAL = analogCal(1.0 / 0.005, 1.25);
+
+// The integer path has to agree with the float formulas it replaced, to within a thousandth.
+// These are the ends of the range, host/test/test_analog_cal.cpp sweeps every sum in between.
+static_assert(analogToMilli(CO2_CAL, 0) == 0, "CO2 zero");
+static_assert(analogToMilli(CO2_CAL, ADC_FULL_SCALE * ADC_WINDOW) == 1320000, "CO2 full scale");
+static_assert(analogToMilli(LEAF_TEMP_CAL, 0) == -250000, "leaf temp zero");
+static_assert(analogToMilli(LEAF_TEMP_CAL, ADC_FULL_SCALE * ADC_WINDOW) == 410000, "leaf temp full scale");
+
+#endif // _ANALOGCAL_H_
@@ -0,0 +1,57 @@
+#include "AnalogSampler.h"
+
+static AnalogSampler *sampler = NULL; // the Timer callback has no context pointer
+
+AnalogSampler::AnalogSampler() : _timer(ADC_SAMPLE_PERIOD, sampleAll) {
+  _channels = 0;
+  _samples = 0;
+  _next = 0;
+}
+
+// Returns the channel number, or -1 when all channels are taken. Add every channel before begin().
+int AnalogSampler::addChannel(int pin) {
+  if(_channels >= ADC_MAX_CHANNELS) {
+    return -1;
+  }
+  _pins[_channels] = pin;
+  _sums[_channels] = 0;
+  memset(_ring[_channels], 0, sizeof(_ring[_channels]));
+  return _channels++;
+}
+
+void AnalogSampler::begin() {
+  int i;
+
+  for(i = 0; i < _channels; i++) {
+    pinMode(_pins[i], INPUT);
+  }
+  sampler = this;
+  _timer.start();
+}
+
+// Drops the sample leaving the window from the sum and adds the new one
+void AnalogSampler::sampleAll() {
+  AnalogSampler *s = sampler;
+  uint16_t reading;
+  int i;
+
+  if(s == NULL) {
+    return;
+  }
+  for(i = 0; i < s->_channels; i++) {
+    reading = analogRead(s->_pins[i]);
+    s->_sums[i] = s->_sums[i] - s->_ring[i][s->_next] + reading;
+    s->_ring[i][s->_next] = reading;
+  }
+  s->_next = (s->_next + 1 == ADC_WINDOW) ? 0 : s->_next + 1;
+  s->_samples++;
+}
+
+// Sum of the last ADC_WINDOW samples, what an AnalogCal takes. Before ready() it only holds
+// the samples taken so far.
+uint32_t AnalogSampler::sum(int channel) {
+  if(channel < 0 || channel >= _channels) {
+    return 0;
+  }
+  return _sums[channel];
+}
@@ -0,0 +1,42 @@
+#ifndef _ANALOGSAMPLER_H_
+#define _ANALOGSAMPLER_H_
+
+#include "Particle.h"
+
+const int ADC_MAX_CHANNELS = 2;
+const int ADC_SAMPLE_PERIOD = 1;   // ms between samples of every channel
+const int ADC_WINDOW = 100;        // samples averaged, 100ms is whole cycles of both 50Hz and 60Hz ripple
+
+// Samples a few analog pins in the background and keeps a moving average over the last
+// ADC_WINDOW samples of each. Averaging N samples of a noisy input gains about log2(sqrt(N))
+// bits, a bit over 3 for 100 samples, and since the window spans whole mains cycles the
+// ripple averages out instead of aliasing.
+//
+// Device OS has no public DMA or timer triggered ADC, so a software Timer does the sampling.
+// Its callback runs on the timer thread, never in loop(), and only does analogRead()s and a
+// running sum update. The sums are single 32-bit words, so loop() can read them without locking.
+//
+// A sum only covers ADC_WINDOW samples once ready(), which is ADC_WINDOW ms after begin().
+// Nothing is extrapolated before that, callers wait for ready().
+class AnalogSampler {
+
+  Timer _timer;
+  int _channels;
+  int _pins[ADC_MAX_CHANNELS];
+  uint16_t _ring[ADC_MAX_CHANNELS][ADC_WINDOW];
+  volatile uint32_t _sums[ADC_MAX_CHANNELS];
+  volatile uint32_t _samples; // total taken, for "is the window full yet"
+  int _next;                  // ring slot the next sample goes in
+
+  static void sampleAll();
+
+  public:
+    AnalogSampler();
+
+    int addChannel(int pin);
+    void begin();
+    bool ready() { return _samples >= (uint32_t)ADC_WINDOW; }
+    uint32_t sum(int channel);
+};
+
+#endif // _ANALOGSAMPLER_H_
@@ -0,0 +1,81 @@
+#include "FluxEngine.h"
+
+FluxEngine::FluxEngine(float volume, float area, unsigned int window) {
+  _volume = volume;
+  _area = area;
+  _pressure = STANDARD_PRESSURE;
+  _window = window;
+  begin(0);
+}
+
+// Call at chamber closure, or once the closed chamber has settled
+void FluxEngine::begin(unsigned int now) {
+  _start = now;
+  _t0 = 0;
+  _w0 = 0;
+  _c0 = 0;
+  _tFirst = _tLast = 0;
+  _st = _sc = _stt = _stc = _scc = 0;
+  _n = 0;
+}
+
+// Returns false once the window is over and the sample was left out
+bool FluxEngine::add(unsigned int now, float co2, float tempC, float rh) {
+  unsigned int elapsed = now - _start;
+  double t, c;
+  float w;
+
+  if(elapsed > _window) {
+    return false;
+  }
+  w = waterFraction(tempC, rh, _pressure);
+  c = co2 / (1.0 - w);
+  if(_n == 0) {
+    _t0 = tempC;
+    _w0 = w;
+    _c0 = c;
+    _tFirst = elapsed / 1000.0;
+  }
+  // Relative to the start keeps the squares small
+  t = elapsed / 1000.0;
+  _tLast = t;
+  c -= _c0;
+  _st += t;
+  _sc += c;
+  _stt += t * t;
+  _stc += t * c;
+  _scc += c * c;
+  _n++;
+  return true;
+}
+
+bool FluxEngine::result(FluxResult *out) {
+  double vt, vc, cov;
+  double airMoles;
+
+  out->samples = _n;
+  out->slope = out->flux = out->r2 = out->seconds = 0;
+  if(_n < 3) {
+    return false;
+  }
+  vt = _n * _stt - _st * _st;
+  vc = _n * _scc - _sc * _sc;
+  cov = _n * _stc - _st * _sc;
+  if(vt <= 0) {
+    return false;
+  }
+  out->slope = cov / vt;
+  out->r2 = (vc > 0) ? (cov * cov) / (vt * vc) : 0;
+  out->seconds = _tLast - _tFirst;
+  airMoles = _pressure * 1000.0 * _volume * (1.0 - _w0) / (GAS_CONSTANT * (_t0 + 273.15));
+  out->flux = out->slope * airMoles / _area;
+  return true;
+}
+
+// Mole fraction of water vapour, saturation pressure from the Magnus formula (WMO constants)
+float FluxEngine::waterFraction(float tempC, float rh, float kPa) {
+  float saturation;
+
+  saturation = 0.6112 * expf(17.62 * tempC / (243.12 + tempC)); // kPa
+  return constrain(rh / 100.0f, 0.0f, 1.0f) * saturation / kPa;
+}
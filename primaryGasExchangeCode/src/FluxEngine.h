@@ -0,0 +1,53 @@
+#ifndef _FLUXENGINE_H_
+#define _FLUXENGINE_H_
+
+#include "Particle.h"
+
+const float GAS_CONSTANT = 8.314;          // J/(mol K)
+const float STANDARD_PRESSURE = 101.325;   // kPa
+
+struct FluxResult {
+  float slope;   // d(CO2)/dt, dry air ppm/s
+  float flux;    // umol m-2 s-1, positive when CO2 goes up (respiration)
+  float r2;
+  int samples;
+  float seconds; // span of the samples
+};
+
+// Closed chamber CO2 flux, worked out as samples arrive rather than from a log afterwards.
+//
+// Every sample is corrected for dilution by water vapour, C' = C / (1 - W), with W the mole
+// fraction of water from chamber temperature and RH, and goes into running sums for a straight
+// line fit of C' against time. add() is O(1) and result() is good at any point, so the fit can
+// be watched while the chamber is closed. Samples after the window are ignored.
+//
+// The flux is the slope scaled by the moles of dry air in the chamber at closure per leaf area:
+//
+//   F = dC'/dt * P V (1 - W0) / (R (T0 + 273.15) A)
+class FluxEngine {
+
+  float _volume;        // m^3
+  float _area;          // m^2
+  float _pressure;      // kPa
+  unsigned int _window; // ms
+  unsigned int _start;
+  float _t0, _w0;       // chamber temperature and water fraction at the first sample
+  double _c0;           // first corrected CO2, the fit is done relative to it
+  float _tFirst, _tLast; // s since begin()
+  double _st, _sc, _stt, _stc, _scc;
+  int _n;
+
+  public:
+    FluxEngine(float volume, float area, unsigned int window);
+
+    void setPressure(float kPa) { _pressure = kPa; }
+    void setWindow(unsigned int ms) { _window = ms; }
+    void begin(unsigned int now);
+    bool add(unsigned int now, float co2, float tempC, float rh);
+    bool result(FluxResult *out);
+    bool done(unsigned int now) { return now - _start >= _window; }
+
+    static float waterFraction(float tempC, float rh, float kPa);
+};
+
+#endif // _FLUXENGINE_H_
@@ -0,0 +1,66 @@
+#include "NumberField.h"
+
+NumberField::NumberField(Adafruit_GFX *gfx, int16_t x, int16_t y, uint8_t chars, uint8_t size, uint16_t color, uint16_t bg) {
+  _gfx = gfx;
+  _x = x;
+  _y = y;
+  _chars = (chars > FIELD_MAX_CHARS) ? FIELD_MAX_CHARS : chars;
+  _size = size;
+  _color = color;
+  _bg = bg;
+  _shown[0] = '\0';
+  _valid = false;
+}
+
+// Drops decimals until the number fits, shows #'s if it still doesn't
+void NumberField::print(float value, int decimals) {
+  char text[16];
+  int len;
+
+  len = snprintf(text, sizeof(text), "%.*f", decimals, value);
+  while(len > _chars && decimals > 0) {
+    decimals--;
+    len = snprintf(text, sizeof(text), "%.*f", decimals, value);
+  }
+  if(len < 0 || len > _chars) {
+    memset(text, '#', _chars);
+    text[_chars] = '\0';
+  }
+  printText(text);
+}
+
+// Left aligned, padded with spaces so a shorter value blanks the old tail
+void NumberField::printText(const char *text) {
+  char next[FIELD_MAX_CHARS + 1];
+  int i;
+
+  for(i = 0; i < _chars && text[i] != '\0'; i++) {
+    next[i] = text[i];
+  }
+  for(; i < _chars; i++) {
+    next[i] = ' ';
+  }
+  next[_chars] = '\0';
+
+  for(i = 0; i < _chars; i++) {
+    if(_valid && next[i] == _shown[i]) {
+      continue;
+    }
+    _gfx->drawChar(_x + i * 6 * _size, _y, next[i], _color, _bg, _size);
+  }
+  memcpy(_shown, next, sizeof(next));
+  _valid = true;
+}
+
+// Forces a full repaint on the next print, e.g. after the screen was cleared
+void NumberField::invalidate() {
+  _valid = false;
+}
+
+// Moves the field onto another surface, e.g. an off-screen tile at 0,0
+void NumberField::setTarget(Adafruit_GFX *gfx, int16_t x, int16_t y) {
+  _gfx = gfx;
+  _x = x;
+  _y = y;
+  _valid = false;
+}
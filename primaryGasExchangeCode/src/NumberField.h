@@ -0,0 +1,35 @@
+#ifndef _NUMBERFIELD_H_
+#define _NUMBERFIELD_H_
+
+#include "Particle.h"
+#include <Adafruit_GFX.h>
+
+const int FIELD_MAX_CHARS = 8;
+
+// A fixed width run of classic font character cells. It remembers what it last drew and only
+// repaints the cells whose character changed. Characters are drawn with an opaque background,
+// so there is no clear pass and nothing flickers.
+class NumberField {
+
+  Adafruit_GFX *_gfx;
+  int16_t _x, _y;
+  uint8_t _chars;
+  uint8_t _size;
+  uint16_t _color, _bg;
+  char _shown[FIELD_MAX_CHARS + 1];
+  bool _valid;
+
+  public:
+    NumberField(Adafruit_GFX *gfx, int16_t x, int16_t y, uint8_t chars, uint8_t size, uint16_t color, uint16_t bg);
+
+    void print(float value, int decimals);
+    void printText(const char *text);
+    void invalidate();
+    void setTarget(Adafruit_GFX *gfx, int16_t x, int16_t y);
+    int16_t x() { return _x; }
+    int16_t y() { return _y; }
+    int16_t width() { return _chars * 6 * _size; }
+    int16_t height() { return 8 * _size; }
+};
+
+#endif // _NUMBERFIELD_H_
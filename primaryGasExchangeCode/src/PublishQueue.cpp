@@ -0,0 +1,154 @@
+#include "PublishQueue.h"
+
+const int32_t PUBLISH_MISSING = INT32_MIN;
+
+PublishQueue::PublishQueue(const char *event, publish_fn_t publish, unsigned int maxAge) {
+  int i;
+
+  _event = event;
+  _publish = publish;
+  _maxAge = maxAge;
+  _head = 0;
+  _count = 0;
+  _dropped = 0;
+  _lastAttempt = 0;
+  _wait = 0;
+  _published = 0;
+  for(i = 0; i < PUBLISH_CHANNELS; i++) {
+    _scale[i] = 1.0;
+  }
+}
+
+void PublishQueue::setDecimals(int channel, int decimals) {
+  if(channel < 0 || channel >= PUBLISH_CHANNELS) {
+    return;
+  }
+  _scale[channel] = powf(10, decimals);
+}
+
+// One value per channel. Overwrites the oldest row when the queue is full.
+void PublishQueue::add(uint32_t nowMs, const float *values, uint32_t sequence) {
+  Row *row = push(values, sequence);
+
+  row->time = nowMs;
+  row->restored = false;
+}
+
+// A row from before a reset, with the unix time it was taken at. Restored rows go in before
+// the first add(), oldest first.
+void PublishQueue::restore(uint32_t unixTime, const float *values, uint32_t sequence) {
+  Row *row = push(values, sequence);
+
+  row->time = unixTime;
+  row->restored = true;
+}
+
+PublishQueue::Row *PublishQueue::push(const float *values, uint32_t sequence) {
+  Row *row;
+  int i;
+
+  if(_count == PUBLISH_QUEUE_ROWS) {
+    _head = (_head + 1) % PUBLISH_QUEUE_ROWS;
+    _count--;
+    _dropped++;
+  }
+  row = &_rows[(_head + _count) % PUBLISH_QUEUE_ROWS];
+  row->sequence = sequence;
+  for(i = 0; i < PUBLISH_CHANNELS; i++) {
+    row->values[i] = isfinite(values[i]) ? (int32_t)lroundf(constrain(values[i] * _scale[i], -2e9f, 2e9f)) : PUBLISH_MISSING;
+  }
+  _count++;
+  return row;
+}
+
+// Publishes at most one batch, true when one went out. nowUnix turns row times into wall
+// clock time, so only call with online when the clock has been synced.
+bool PublishQueue::update(bool online, uint32_t nowMs, uint32_t nowUnix) {
+  char data[PUBLISH_MAX_DATA + 1];
+  int rows;
+
+  if(!online || _count == 0 || _publish == NULL) {
+    return false;
+  }
+  if(_wait > 0 && nowMs - _lastAttempt < _wait) {
+    return false;
+  }
+  // Goes when the event is full, or the oldest row has waited long enough
+  rows = format(nowMs, nowUnix, data, sizeof(data));
+  if(rows == 0 || (rows == _count && age(&_rows[_head], nowMs, nowUnix) < _maxAge)) {
+    return false;
+  }
+
+  _lastAttempt = nowMs;
+  if(!_publish(_event, data)) {
+    _wait = (_wait < PUBLISH_MIN_INTERVAL) ? 2 * PUBLISH_MIN_INTERVAL : 2 * _wait;
+    if(_wait > PUBLISH_MAX_BACKOFF) {
+      _wait = PUBLISH_MAX_BACKOFF;
+    }
+    return false;
+  }
+  _published = _rows[(_head + rows - 1) % PUBLISH_QUEUE_ROWS].sequence + 1;
+  _head = (_head + rows) % PUBLISH_QUEUE_ROWS;
+  _count -= rows;
+  _wait = PUBLISH_MIN_INTERVAL;
+  return true;
+}
+
+uint32_t PublishQueue::unixTime(const Row *row, uint32_t nowMs, uint32_t nowUnix) {
+  return row->restored ? row->time : nowUnix - (nowMs - row->time) / 1000;
+}
+
+// ms since the row was taken, a restored row's only to the second
+uint32_t PublishQueue::age(const Row *row, uint32_t nowMs, uint32_t nowUnix) {
+  int32_t seconds;
+
+  if(!row->restored) {
+    return nowMs - row->time;
+  }
+  seconds = nowUnix - row->time;
+  if(seconds < 0) {
+    return 0;
+  }
+  return ((uint32_t)seconds < UINT32_MAX / 1000) ? seconds * 1000 : UINT32_MAX;
+}
+
+// Writes as many of the oldest rows as fit, returns how many. Between two rows timed by
+// millis() the gap is rounded from ms, next to a restored row it's whole unix seconds.
+int PublishQueue::format(uint32_t nowMs, uint32_t nowUnix, char *data, size_t size) {
+  char line[16 * (PUBLISH_CHANNELS + 1)];
+  size_t used = 0;
+  size_t len;
+  Row *previous = NULL;
+  Row *row;
+  int rows;
+  int i;
+
+  data[0] = '\0';
+  for(rows = 0; rows < _count; rows++) {
+    row = &_rows[(_head + rows) % PUBLISH_QUEUE_ROWS];
+    if(previous == NULL) {
+      len = snprintf(line, sizeof(line), "%lu", (unsigned long)unixTime(row, nowMs, nowUnix));
+    }
+    else if(!row->restored && !previous->restored) {
+      len = snprintf(line, sizeof(line), ";%lu", (unsigned long)((row->time - previous->time + 500) / 1000));
+    }
+    else {
+      len = snprintf(line, sizeof(line), ";%ld", (long)(int32_t)(unixTime(row, nowMs, nowUnix) - unixTime(previous, nowMs, nowUnix)));
+    }
+    for(i = 0; i < PUBLISH_CHANNELS; i++) {
+      if(row->values[i] == PUBLISH_MISSING) {
+        len += snprintf(line + len, sizeof(line) - len, ",");
+      }
+      else {
+        len += snprintf(line + len, sizeof(line) - len, ",%ld", (long)row->values[i]);
+      }
+    }
+    if(used + len >= size) {
+      break;
+    }
+    memcpy(data + used, line, len + 1);
+    used += len;
+    previous = row;
+  }
+  return rows;
+}
@@ -0,0 +1,71 @@
+#ifndef _PUBLISHQUEUE_H_
+#define _PUBLISHQUEUE_H_
+
+#include "Particle.h"
+
+const int PUBLISH_CHANNELS = 7;
+const int PUBLISH_QUEUE_ROWS = 240;          // 40 minutes at one row per 10s, in RAM
+const int PUBLISH_MAX_DATA = 600;            // under the cloud's event data limit on every Device OS
+const unsigned int PUBLISH_MIN_INTERVAL = 1000;    // ms, the cloud allows about one event a second
+const unsigned int PUBLISH_MAX_BACKOFF = 300000;   // ms
+
+// Hands an event to the cloud (or a mock), true when it was accepted
+typedef bool (*publish_fn_t)(const char *event, const char *data);
+
+// Collects sensor rows and publishes them in batches, so sampling never waits on the cloud.
+//
+// add() only copies a row into a ring, the network is touched in update(), at most one
+// publish per call. A batch goes out when it would fill an event or its oldest row reaches
+// maxAge. While offline rows keep queueing, the oldest are dropped once it's full. A failed
+// publish doubles the wait before the next try, up to PUBLISH_MAX_BACKOFF, and a success goes
+// back to PUBLISH_MIN_INTERVAL so a backlog drains as fast as the rate limit allows.
+//
+// The ring itself is RAM and doesn't survive a reset. Each row carries the sequence number its
+// copy in the SampleLog got, published() says how far the cloud has them, and after a reset
+// restore() puts rows from the log back in front of the new ones.
+//
+// Event data is text, rows separated by ';' and values by ',':
+//   <unix time>,<v0>,<v1>,...;<seconds since previous row>,<v0>,...;...
+// Each value is an integer in the channel's steps, 10^-decimals (setDecimals), empty if it
+// wasn't a number.
+class PublishQueue {
+
+  struct Row {
+    uint32_t time;      // millis() when added, unix time for a restored row
+    uint32_t sequence;  // the caller's, e.g. the row's SampleLog sequence
+    bool restored;
+    int32_t values[PUBLISH_CHANNELS];
+  };
+
+  Row _rows[PUBLISH_QUEUE_ROWS];
+  int _head;        // oldest row
+  int _count;
+  uint32_t _dropped;
+  float _scale[PUBLISH_CHANNELS];
+  const char *_event;
+  publish_fn_t _publish;
+  unsigned int _maxAge;
+  unsigned int _lastAttempt;
+  unsigned int _wait;
+  uint32_t _published;
+
+  Row *push(const float *values, uint32_t sequence);
+  uint32_t unixTime(const Row *row, uint32_t nowMs, uint32_t nowUnix);
+  uint32_t age(const Row *row, uint32_t nowMs, uint32_t nowUnix);
+  int format(uint32_t nowMs, uint32_t nowUnix, char *data, size_t size);
+
+  public:
+    PublishQueue(const char *event, publish_fn_t publish, unsigned int maxAge);
+
+    void setDecimals(int channel, int decimals);
+    void add(uint32_t nowMs, const float *values, uint32_t sequence = 0);
+    void restore(uint32_t unixTime, const float *values, uint32_t sequence);
+    bool update(bool online, uint32_t nowMs, uint32_t nowUnix);
+
+    int count() { return _count; }
+    uint32_t dropped() { return _dropped; }
+    unsigned int backoff() { return _wait; }
+    uint32_t published() { return _published; }
+};
+
+#endif // _PUBLISHQUEUE_H_
@@ -0,0 +1,352 @@
+#include "SampleLog.h"
+#include "Telemetry.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+static_assert(sizeof(LogRecord) == LOG_RECORD_SIZE, "records are read and written whole");
+
+// Queue entries that aren't records have one of these as their count
+const uint8_t LOG_MARK = 0xFD;   // the sequence is the new mark
+const uint8_t LOG_FLUSH = 0xFE;  // answer on _flushed once everything before has been written
+const uint8_t LOG_STOP = 0xFF;   // end the writer
+
+// The mark file: the sequence, then a CRC of it
+struct LogMark {
+  uint32_t sequence;
+  uint16_t crc;
+  uint16_t pad;
+};
+
+SampleLog::SampleLog(const char *path) {
+  _path = path;
+  _next = 0;
+  _written = 0;
+  _failed = 0;
+  _dropped = 0;
+  _queue = NULL;
+  _flushed = NULL;
+  _writer = NULL;
+  _fd = -1;
+  _segment = 0;
+  _marked = 0;
+  _pageCount = 0;
+}
+
+SampleLog::~SampleLog() {
+  end();
+}
+
+// Finds where the last run stopped and starts the writer. False if the log can't be written.
+bool SampleLog::begin() {
+  LogRecord last;
+  bool found = false;
+  char path[64];
+  uint32_t file;
+  int fd;
+
+  if(_writer != NULL) {
+    return true;
+  }
+  _next = 0;
+  for(file = 0; file < LOG_SEGMENTS; file++) {
+    if(findTail(file, &last) && (!found || last.sequence >= _next)) {
+      _next = last.sequence + 1;
+      found = true;
+    }
+  }
+  _written = _next;
+
+  markPath(path, sizeof(path));
+  fd = open(path, O_RDONLY);
+  if(fd >= 0) {
+    LogMark mark;
+
+    if(::read(fd, &mark, sizeof(mark)) == sizeof(mark) &&
+       mark.crc == Telemetry::crc16((const uint8_t *)&mark, offsetof(LogMark, crc))) {
+      _marked = mark.sequence;
+    }
+    close(fd);
+  }
+
+  segmentPath((_next / LOG_SEGMENT_RECORDS) % LOG_SEGMENTS, path, sizeof(path));
+  fd = open(path, O_WRONLY | O_CREAT, 0666);
+  if(fd < 0) {
+    return false;
+  }
+  close(fd);
+  if(os_queue_create(&_queue, sizeof(LogRecord), LOG_QUEUE_RECORDS, NULL) != 0 ||
+     os_queue_create(&_flushed, 1, 1, NULL) != 0) {
+    return false;
+  }
+  _writer = new Thread("sampleLog", run, this);
+  return true;
+}
+
+// Stops the writer once the queue has drained
+void SampleLog::end() {
+  LogRecord marker;
+
+  if(_writer == NULL) {
+    return;
+  }
+  memset(&marker, 0, sizeof(marker));
+  marker.count = LOG_STOP;
+  os_queue_put(_queue, &marker, CONCURRENT_WAIT_FOREVER, NULL);
+  _writer->join();
+  delete _writer;
+  _writer = NULL;
+  os_queue_destroy(_queue, NULL);
+  os_queue_destroy(_flushed, NULL);
+  _queue = _flushed = NULL;
+}
+
+// Non-numbers are stored as INT32_MIN. Never waits: false if the writer has fallen
+// LOG_QUEUE_RECORDS behind and the row had to be dropped.
+bool SampleLog::append(uint32_t time, uint32_t millis, const float *values, int count) {
+  LogRecord record;
+  int i;
+
+  if(_writer == NULL) {
+    return false;
+  }
+  if(count > LOG_MAX_VALUES) {
+    count = LOG_MAX_VALUES;
+  }
+  memset(&record, 0, sizeof(record));
+  record.sequence = _next;
+  record.time = time;
+  record.millis = millis;
+  record.count = count;
+  for(i = 0; i < count; i++) {
+    record.values[i] = isfinite(values[i]) ? (int32_t)lroundf(constrain(values[i], -2000000.0f, 2000000.0f) * 1000) : INT32_MIN;
+  }
+  record.crc = Telemetry::crc16((const uint8_t *)&record, offsetof(LogRecord, crc));
+  if(os_queue_put(_queue, &record, 0, NULL) != 0) {
+    _dropped++;
+    return false;
+  }
+  _next++;
+  return true;
+}
+
+// Keeps one number with the log, e.g. how far another copy of the rows has got. Written by the
+// writer thread like the records, marked() has it back after a reset.
+void SampleLog::mark(uint32_t sequence) {
+  LogRecord marker;
+
+  if(_writer == NULL) {
+    return;
+  }
+  memset(&marker, 0, sizeof(marker));
+  marker.count = LOG_MARK;
+  marker.sequence = sequence;
+  if(os_queue_put(_queue, &marker, 0, NULL) == 0) {
+    _marked = sequence;
+  }
+}
+
+// Waits until everything appended so far is on flash, e.g. before a planned reset
+bool SampleLog::flush(unsigned int timeout) {
+  LogRecord marker;
+  uint8_t done;
+
+  if(_writer == NULL) {
+    return false;
+  }
+  while(os_queue_take(_flushed, &done, 0, NULL) == 0) {
+    // left by a flush that timed out
+  }
+  memset(&marker, 0, sizeof(marker));
+  marker.count = LOG_FLUSH;
+  if(os_queue_put(_queue, &marker, timeout, NULL) != 0) {
+    return false;
+  }
+  return os_queue_take(_flushed, &done, timeout, NULL) == 0 && _written == _next;
+}
+
+// The current segment and the LOG_SEGMENTS - 1 before it
+uint32_t SampleLog::oldest() {
+  uint32_t segment = _next / LOG_SEGMENT_RECORDS;
+
+  return (segment >= LOG_SEGMENTS - 1) ? (segment - (LOG_SEGMENTS - 1)) * LOG_SEGMENT_RECORDS : 0;
+}
+
+// False before the record is on flash and once its segment has been reused. Opens the file
+// for each call, so it never shares a file position with the writer.
+bool SampleLog::read(uint32_t sequence, LogRecord *record) {
+  char path[64];
+  bool found;
+  int fd;
+
+  if(sequence >= _written || sequence < oldest()) {
+    return false;
+  }
+  segmentPath((sequence / LOG_SEGMENT_RECORDS) % LOG_SEGMENTS, path, sizeof(path));
+  fd = open(path, O_RDONLY);
+  if(fd < 0) {
+    return false;
+  }
+  found = readRecord(fd, sequence % LOG_SEGMENT_RECORDS, record) && record->sequence == sequence;
+  close(fd);
+  return found;
+}
+
+// The writer thread: records off the queue into the page buffer, and onto flash a page at a time
+os_thread_return_t SampleLog::run(void *log) {
+  SampleLog *self = (SampleLog *)log;
+  LogRecord record;
+  uint8_t done = 1;
+
+  while(os_queue_take(self->_queue, &record, CONCURRENT_WAIT_FOREVER, NULL) == 0 && record.count != LOG_STOP) {
+    if(record.count == LOG_FLUSH) {
+      self->writePage();
+      os_queue_put(self->_flushed, &done, 0, NULL);
+    }
+    else if(record.count == LOG_MARK) {
+      self->storeMark(record.sequence);
+    }
+    else {
+      self->store(&record);
+    }
+  }
+  self->writePage();
+  if(self->_fd >= 0) {
+    close(self->_fd);
+    self->_fd = -1;
+  }
+  os_thread_exit(NULL);
+}
+
+// Buffers the record with the rest of its page, the page goes out once it's full
+void SampleLog::store(const LogRecord *record) {
+  if(_pageCount > 0 && (record->sequence != _page[_pageCount - 1].sequence + 1 ||
+                        record->sequence % LOG_PAGE_RECORDS == 0)) {
+    writePage();
+  }
+  _page[_pageCount++] = *record;
+  if((record->sequence + 1) % LOG_PAGE_RECORDS == 0) {
+    writePage();
+  }
+}
+
+// Writes what's buffered of the current page in one write and syncs it. Only a successful
+// write moves _written. The first write to a segment unlinks the file's previous lap, so its
+// blocks are freed rather than rewritten.
+void SampleLog::writePage() {
+  uint32_t first = _page[0].sequence;
+  uint32_t segment = first / LOG_SEGMENT_RECORDS;
+  uint32_t index = first % LOG_SEGMENT_RECORDS;
+  size_t size = _pageCount * sizeof(LogRecord);
+  char path[64];
+
+  if(_pageCount == 0) {
+    return;
+  }
+
+  if(_fd < 0 || segment != _segment) {
+    if(_fd >= 0) {
+      close(_fd);
+    }
+    segmentPath(segment % LOG_SEGMENTS, path, sizeof(path));
+    if(index == 0) {
+      unlink(path);
+    }
+    _fd = open(path, O_WRONLY | O_CREAT, 0666);
+    _segment = segment;
+  }
+  // The end of the file, unless a reset left a torn record there, which this replaces
+  if(_fd < 0 || lseek(_fd, index * LOG_RECORD_SIZE, SEEK_SET) < 0 ||
+     ::write(_fd, _page, size) != (ssize_t)size || fsync(_fd) != 0) {
+    _failed += _pageCount;
+    if(_fd >= 0) {
+      close(_fd);
+      _fd = -1; // opened again for the next page
+    }
+  }
+  else {
+    _written = first + _pageCount;
+  }
+  _pageCount = 0;
+}
+
+// The newest good record of a segment file, false if it has none. Records only ever go on the
+// end of a file, so the good ones run from the start to the tail and a bisection finds it:
+// one read when the last record is good, otherwise at most log2(LOG_SEGMENT_RECORDS) more. A
+// bad record at the start is passed over like a torn one at the end.
+bool SampleLog::findTail(uint32_t file, LogRecord *last) {
+  char path[64];
+  int32_t records, good, bad, middle;
+  bool found;
+  off_t size;
+  int fd;
+
+  segmentPath(file, path, sizeof(path));
+  fd = open(path, O_RDONLY);
+  if(fd < 0) {
+    return false;
+  }
+  size = lseek(fd, 0, SEEK_END);
+  records = (size > 0) ? size / LOG_RECORD_SIZE : 0;
+  if(records > (int32_t)LOG_SEGMENT_RECORDS) {
+    records = LOG_SEGMENT_RECORDS;
+  }
+  found = records > 0 && readRecord(fd, records - 1, last) && inFile(file, last);
+  // good is a good record or -1, bad a bad one or past the end
+  good = -1;
+  bad = records - 1;
+  while(!found && bad - good > 1) {
+    middle = good + (bad - good) / 2;
+    if(readRecord(fd, middle, last) && inFile(file, last)) {
+      good = middle;
+    }
+    else {
+      bad = middle;
+    }
+  }
+  if(!found && good >= 0) {
+    found = readRecord(fd, good, last);
+  }
+  close(fd);
+  return found;
+}
+
+// A record from a lap of the segments that belongs in this file
+bool SampleLog::inFile(uint32_t file, const LogRecord *record) {
+  return (record->sequence / LOG_SEGMENT_RECORDS) % LOG_SEGMENTS == file;
+}
+
+// Rewrites the small mark file in place
+void SampleLog::storeMark(uint32_t sequence) {
+  LogMark mark;
+  char path[64];
+  int fd;
+
+  mark.sequence = sequence;
+  mark.pad = 0;
+  mark.crc = Telemetry::crc16((const uint8_t *)&mark, offsetof(LogMark, crc));
+  markPath(path, sizeof(path));
+  fd = open(path, O_WRONLY | O_CREAT, 0666);
+  if(fd < 0 || ::write(fd, &mark, sizeof(mark)) != sizeof(mark) || fsync(fd) != 0) {
+    _failed++;
+  }
+  if(fd >= 0) {
+    close(fd);
+  }
+}
+
+void SampleLog::markPath(char *path, size_t size) {
+  snprintf(path, size, "%s.mark", _path);
+}
+
+void SampleLog::segmentPath(uint32_t file, char *path, size_t size) {
+  snprintf(path, size, "%s.%lu", _path, (unsigned long)file);
+}
+
+// Past the end of the file, a bad CRC or a record from another position all read as empty
+bool SampleLog::readRecord(int fd, uint32_t index, LogRecord *record) {
+  if(lseek(fd, index * LOG_RECORD_SIZE, SEEK_SET) < 0 || ::read(fd, record, sizeof(LogRecord)) != sizeof(LogRecord)) {
+    return false;
+  }
+  return record->sequence % LOG_SEGMENT_RECORDS == index && record->count <= LOG_MAX_VALUES &&
+         record->crc == Telemetry::crc16((const uint8_t *)record, offsetof(LogRecord, crc));
+}
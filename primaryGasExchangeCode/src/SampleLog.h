@@ -0,0 +1,94 @@
+#ifndef _SAMPLELOG_H_
+#define _SAMPLELOG_H_
+
+#include "Particle.h"
+
+const int LOG_MAX_VALUES = 11;
+const int LOG_RECORD_SIZE = 64;
+const uint32_t LOG_SEGMENT_RECORDS = 1024;  // 64KB a segment file
+const uint32_t LOG_SEGMENTS = 8;            // 7 to 8 segments kept, 20 to 22 hours at one row per 10s
+const uint32_t LOG_PAGE_RECORDS = 8;        // 512 bytes, what the writer buffers before a write
+const int LOG_QUEUE_RECORDS = 16;           // rows that can wait for the writer thread
+const unsigned int LOG_FLUSH_TIMEOUT = 2000; // ms flush() waits for the writer
+
+// One row as it sits in the file, the CRC covers everything before it
+struct LogRecord {
+  uint32_t sequence;    // counts up from 0 forever, see SampleLog
+  uint32_t time;        // unix time, 0 if the clock wasn't synced yet
+  uint32_t millis;
+  uint8_t count;        // values used
+  uint8_t flags;
+  uint16_t reserved;
+  int32_t values[LOG_MAX_VALUES];   // thousandths of the channel's unit
+  uint16_t crc;
+  uint16_t pad;
+};
+
+// Log of sample rows on the device's flash file system, so data survives a dropped USB cable
+// or a reset.
+//
+// Records are fixed size and go into a ring of LOG_SEGMENTS segment files, <path>.0 to
+// <path>.7. Record n is record n % LOG_SEGMENT_RECORDS of segment n / LOG_SEGMENT_RECORDS,
+// which lives in file segment % LOG_SEGMENTS. Files are only ever appended to. When the ring
+// comes round, the segment file being reused is unlinked and started again, so LittleFS never
+// copies the middle of a file.
+//
+// append() only fills in a record and queues it, the loop thread never waits on flash. A
+// writer thread takes records off the queue and buffers them a page (LOG_PAGE_RECORDS) at a
+// time. A full page goes out page aligned in one write and sync, so the block at the end of the
+// open segment is copied once a page rather than once a record. An unplanned reset loses what
+// is queued or buffered, up to LOG_PAGE_RECORDS - 1 rows plus the queue. flush() writes the
+// partial page and waits for the queue to drain, for planned resets.
+//
+// mark() keeps one more number in <path>.mark, the firmware's is the first sequence the cloud
+// hasn't had yet.
+//
+// begin() finds the newest segment and where it ends by a bisection in each file, see
+// findTail(). A record with a bad CRC counts as never written, which is where a crash can
+// leave one.
+class SampleLog {
+
+  const char *_path;
+  uint32_t _next;               // sequence the next append gets
+  volatile uint32_t _written;   // records before this are on flash
+  volatile uint32_t _failed;    // records the writer couldn't write
+  uint32_t _dropped;            // records the queue had no room for
+  os_queue_t _queue;
+  os_queue_t _flushed;
+  Thread *_writer;
+  int _fd;                      // the writer's open segment file
+  uint32_t _segment;            // and which segment it holds
+  uint32_t _marked;
+  LogRecord _page[LOG_PAGE_RECORDS];  // the writer's records not on flash yet, from one page
+  int _pageCount;
+
+  void segmentPath(uint32_t segment, char *path, size_t size);
+  bool findTail(uint32_t file, LogRecord *last);
+  void store(const LogRecord *record);
+  void writePage();
+  void storeMark(uint32_t sequence);
+  void markPath(char *path, size_t size);
+  static bool readRecord(int fd, uint32_t index, LogRecord *record);
+  static bool inFile(uint32_t file, const LogRecord *record);
+  static os_thread_return_t run(void *log);
+
+  public:
+    SampleLog(const char *path);
+    ~SampleLog();
+
+    bool begin();
+    void end();
+    bool append(uint32_t time, uint32_t millis, const float *values, int count);
+    bool flush(unsigned int timeout = LOG_FLUSH_TIMEOUT);
+    void mark(uint32_t sequence);
+
+    uint32_t next() { return _next; }
+    uint32_t written() { return _written; }
+    uint32_t failed() { return _failed; }
+    uint32_t dropped() { return _dropped; }
+    uint32_t marked() { return _marked; }
+    uint32_t oldest();
+    bool read(uint32_t sequence, LogRecord *record);
+};
+
+#endif // _SAMPLELOG_H_
@@ -0,0 +1,98 @@
+#ifndef _TASKSCHEDULER_H_
+#define _TASKSCHEDULER_H_
+
+#include "Particle.h"
+#include "IoTTimer.h"
+
+const int MAX_TASKS = 12;
+
+// One periodic job. The timer says when it is due, the deadline says how late it may run
+// before it jumps ahead of higher priority tasks.
+struct Task {
+  void (*run)();
+  unsigned int period;
+  unsigned int deadline;
+  int priority;
+  unsigned int lastRun;
+  IoTTimer timer;
+};
+
+// Cooperative scheduler: every call to run() dispatches at most one due task so loop() returns
+// quickly and short, high priority jobs (touch) are never stuck behind a whole chain of reads.
+class TaskScheduler {
+
+  Task _tasks[MAX_TASKS];
+  int _taskCount;
+
+  public:
+    TaskScheduler() {
+      _taskCount = 0;
+    }
+
+    // Returns the task id, or -1 when the table is full
+    int addTask(void (*run)(), unsigned int period, int priority, unsigned int deadline) {
+      if(_taskCount >= MAX_TASKS) {
+        return -1;
+      }
+      Task *task = &_tasks[_taskCount];
+      task->run = run;
+      task->period = period;
+      task->priority = priority;
+      task->deadline = deadline;
+      task->lastRun = millis();
+      task->timer.startTimer(0); // due on the first pass
+      return _taskCount++;
+    }
+
+    void setPeriod(int id, unsigned int period) {
+      if(id < 0 || id >= _taskCount) {
+        return;
+      }
+      _tasks[id].period = period;
+      _tasks[id].timer.startTimer(period);
+      _tasks[id].lastRun = millis();
+    }
+
+    unsigned int getPeriod(int id) {
+      if(id < 0 || id >= _taskCount) {
+        return 0;
+      }
+      return _tasks[id].period;
+    }
+
+    // Picks the due task that is furthest past its deadline, otherwise the due task with the
+    // highest priority, and runs it.
+    void run() {
+      unsigned int now = millis();
+      int next = -1;
+      bool nextLate = false;
+      unsigned int nextOverdue = 0;
+
+      for(int i = 0; i < _taskCount; i++) {
+        Task *task = &_tasks[i];
+        if(!task->timer.isTimerReady()) {
+          continue;
+        }
+        unsigned int elapsed = now - task->lastRun;
+        unsigned int overdue = (elapsed > task->period) ? elapsed - task->period : 0;
+        bool late = overdue > task->deadline;
+
+        if(next == -1 ||
+           (late && !nextLate) ||
+           (late && nextLate && overdue > nextOverdue) ||
+           (!late && !nextLate && task->priority > _tasks[next].priority)) {
+          next = i;
+          nextLate = late;
+          nextOverdue = overdue;
+        }
+      }
+      if(next == -1) {
+        return;
+      }
+      _tasks[next].lastRun = now;
+      _tasks[next].timer.startTimer(_tasks[next].period);
+      _tasks[next].run();
+    }
+};
+
+#endif // _TASKSCHEDULER_H_
@@ -0,0 +1,151 @@
+#include "Telemetry.h"
+
+Telemetry::Telemetry(Print *port) {
+  _port = port;
+  _sequence = 0;
+}
+
+// A sample frame, see Telemetry.h
+void Telemetry::send(uint32_t time, const float *values, int count) {
+  sendValues(TELEMETRY_FRAME_SAMPLE, time, values, count);
+}
+
+void Telemetry::sendPhase(uint32_t time, uint8_t phase, uint16_t cycle) {
+  uint8_t raw[TELEMETRY_MAX_RAW];
+  size_t len;
+
+  len = header(raw, TELEMETRY_FRAME_PHASE, time, 3);
+  raw[len++] = phase;
+  raw[len++] = cycle;
+  raw[len++] = cycle >> 8;
+  finish(raw, len);
+}
+
+// values: flux, slope, r2, seconds, samples, as in FluxResult
+void Telemetry::sendFlux(uint32_t time, const float *values, int count) {
+  sendValues(TELEMETRY_FRAME_FLUX, time, values, count);
+}
+
+// Longer text is cut at TELEMETRY_MAX_TEXT characters
+void Telemetry::sendText(uint32_t time, const char *text) {
+  uint8_t raw[TELEMETRY_MAX_RAW];
+  size_t count = strnlen(text, TELEMETRY_MAX_TEXT);
+  size_t len;
+
+  len = header(raw, TELEMETRY_FRAME_TEXT, time, count);
+  memcpy(raw + len, text, count);
+  finish(raw, len + count);
+}
+
+size_t Telemetry::header(uint8_t *raw, uint8_t type, uint32_t time, uint8_t count) {
+  raw[0] = type;
+  raw[1] = _sequence;
+  raw[2] = _sequence >> 8;
+  raw[3] = time;
+  raw[4] = time >> 8;
+  raw[5] = time >> 16;
+  raw[6] = time >> 24;
+  raw[7] = count;
+  return TELEMETRY_HEADER_SIZE;
+}
+
+// Appends the CRC, encodes and writes the frame. raw needs room for the two CRC bytes.
+void Telemetry::finish(uint8_t *raw, size_t len) {
+  uint8_t frame[TELEMETRY_MAX_RAW + TELEMETRY_MAX_RAW / 254 + 2];
+  size_t frameLen;
+  uint16_t crc;
+
+  crc = crc16(raw, len);
+  raw[len++] = crc;
+  raw[len++] = crc >> 8;
+
+  frameLen = cobsEncode(raw, len, frame);
+  frame[frameLen++] = 0x00;
+  _port->write(frame, frameLen);
+  _sequence++;
+}
+
+// A value that isn't a number goes out as INT32_MIN
+void Telemetry::sendValues(uint8_t type, uint32_t time, const float *values, int count) {
+  uint8_t raw[TELEMETRY_MAX_RAW];
+  size_t len;
+  int32_t milli;
+  int i;
+
+  if(count > TELEMETRY_MAX_CHANNELS) {
+    count = TELEMETRY_MAX_CHANNELS;
+  }
+  len = header(raw, type, time, count);
+  for(i = 0; i < count; i++) {
+    milli = isfinite(values[i]) ? (int32_t)lroundf(constrain(values[i], -2000000.0f, 2000000.0f) * 1000) : INT32_MIN;
+    raw[len++] = milli;
+    raw[len++] = milli >> 8;
+    raw[len++] = milli >> 16;
+    raw[len++] = milli >> 24;
+  }
+  finish(raw, len);
+}
+
+// CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, no reflection
+uint16_t Telemetry::crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  int bit;
+
+  while(len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for(bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+// Consistent overhead byte stuffing. Each zero is replaced by the distance to the next one, out
+// needs len + len / 254 + 1 bytes. The trailing 0x00 delimiter is left to the caller.
+size_t Telemetry::cobsEncode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t code = 0;      // where the current block's length byte goes
+  size_t o = 1;
+  uint8_t run = 1;
+  size_t i;
+
+  for(i = 0; i < len; i++) {
+    if(in[i] != 0) {
+      out[o++] = in[i];
+      run++;
+    }
+    if(in[i] == 0 || run == 0xFF) {
+      out[code] = run;
+      code = o++;
+      run = 1;
+    }
+  }
+  out[code] = run;
+  return o;
+}
+
+TelemetryText::TelemetryText(Telemetry *telemetry) {
+  _telemetry = telemetry;
+  _length = 0;
+}
+
+size_t TelemetryText::write(uint8_t c) {
+  if(c == '\n') {
+    sendLine();
+  }
+  else if(c != '\r') {
+    _line[_length++] = c;
+    if(_length == (size_t)TELEMETRY_MAX_TEXT) {
+      sendLine();
+    }
+  }
+  return 1;
+}
+
+void TelemetryText::sendLine() {
+  if(_length == 0) {
+    return;
+  }
+  _line[_length] = 0;
+  _telemetry->sendText(millis(), _line);
+  _length = 0;
+}
@@ -0,0 +1,76 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "Particle.h"
+
+const int TELEMETRY_MAX_CHANNELS = 16;
+const int TELEMETRY_MAX_TEXT = 4 * TELEMETRY_MAX_CHANNELS;
+
+// Frame types, the first byte of a frame
+const uint8_t TELEMETRY_FRAME_SAMPLE = 0x01; // a reading of every channel
+const uint8_t TELEMETRY_FRAME_PHASE = 0x02;  // the valve sequencer changed phase
+const uint8_t TELEMETRY_FRAME_FLUX = 0x03;   // a finished flux fit
+const uint8_t TELEMETRY_FRAME_TEXT = 0x04;   // a status or error message
+
+// Raw frame: type, sequence, time, count and the body, then the CRC
+const int TELEMETRY_HEADER_SIZE = 8;
+const int TELEMETRY_MAX_RAW = TELEMETRY_HEADER_SIZE + 4 * TELEMETRY_MAX_CHANNELS + 2;
+
+// Binary frames over a serial port, one COBS encoded frame per send, each ending in 0x00.
+//
+// Frame before encoding, little endian:
+//   uint8  type, TELEMETRY_FRAME_*
+//   uint16 sequence, shared by all types and wraps, a gap means frames were lost
+//   uint32 millis() when sent
+//   uint8  count, items in the body
+//   body:
+//     SAMPLE  int32 per channel, thousandths of the channel's unit, INT32_MIN when missing
+//     PHASE   count 3: uint8 ValvePhase, uint16 cycle
+//     FLUX    int32 thousandths of flux (umol m-2 s-1), slope (ppm/s), r2, seconds, samples
+//     TEXT    count ASCII characters, no terminator
+//   uint16 CRC-16/CCITT-FALSE over everything before it
+//
+// COBS leaves no 0x00 inside a frame, so a reader can always find the next frame boundary.
+// Everything the firmware says on the port goes out as a frame; tools/telemetry_decode.py
+// writes samples as CSV and the other types to stderr.
+class Telemetry {
+
+  Print *_port;
+  uint16_t _sequence;
+
+  size_t header(uint8_t *raw, uint8_t type, uint32_t time, uint8_t count);
+  void finish(uint8_t *raw, size_t len);
+  void sendValues(uint8_t type, uint32_t time, const float *values, int count);
+
+  public:
+    Telemetry(Print *port);
+
+    void send(uint32_t time, const float *values, int count);
+    void sendPhase(uint32_t time, uint8_t phase, uint16_t cycle);
+    void sendFlux(uint32_t time, const float *values, int count);
+    void sendText(uint32_t time, const char *text);
+    uint16_t sequence() { return _sequence; }
+
+    static uint16_t crc16(const uint8_t *data, size_t len);
+    static size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out);
+};
+
+// A Print that sends each line written to it as a TEXT frame, for text that would otherwise
+// land on the port between frames, like Instrumentation's dumps. A line longer than
+// TELEMETRY_MAX_TEXT goes out in pieces, line ends aren't sent.
+class TelemetryText : public Print {
+
+  Telemetry *_telemetry;
+  char _line[TELEMETRY_MAX_TEXT + 1];
+  size_t _length;
+
+  void sendLine();
+
+  public:
+    TelemetryText(Telemetry *telemetry);
+
+    size_t write(uint8_t c);
+    using Print::write;
+};
+
+#endif // _TELEMETRY_H_
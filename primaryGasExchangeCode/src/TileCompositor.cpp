@@ -0,0 +1,74 @@
+#include "TileCompositor.h"
+
+TileCompositor::TileCompositor(Adafruit_SPITFT *tft, size_t budgetBytes) {
+  _tft = tft;
+  _count = 0;
+  _budget = budgetBytes;
+  _used = 0;
+}
+
+TileCompositor::~TileCompositor() {
+  int i;
+
+  for(i = 0; i < _count; i++) {
+    delete _tiles[i];
+  }
+}
+
+// Returns the tile id, or -1 when it doesn't fit the budget or the heap
+int TileCompositor::addTile(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+  size_t bytes = (size_t)w * h * 2;
+  Tile *tile;
+
+  if(_count >= MAX_TILES || _used + bytes > _budget) {
+    return -1;
+  }
+  tile = new Tile(x, y, w, h);
+  if(tile == NULL || tile->getBuffer() == NULL) {
+    delete tile;
+    return -1;
+  }
+  _tiles[_count] = tile;
+  _used += bytes;
+  return _count++;
+}
+
+Adafruit_GFX *TileCompositor::canvas(int id) {
+  if(id < 0 || id >= _count) {
+    return NULL;
+  }
+  return _tiles[id];
+}
+
+// One transaction for the whole frame, one address window and pixel burst per changed tile
+void TileCompositor::flush() {
+  int i;
+  bool started = false;
+  Tile *tile;
+
+  for(i = 0; i < _count; i++) {
+    tile = _tiles[i];
+    if(!tile->dirty) {
+      continue;
+    }
+    if(!started) {
+      _tft->startWrite();
+      started = true;
+    }
+    _tft->setAddrWindow(tile->screenX, tile->screenY, tile->width(), tile->height());
+    _tft->writePixels(tile->getBuffer(), (uint32_t)tile->width() * tile->height());
+    tile->dirty = false;
+  }
+  if(started) {
+    _tft->endWrite();
+  }
+}
+
+// Sends every tile again on the next flush(), e.g. after the screen was cleared
+void TileCompositor::invalidate() {
+  int i;
+
+  for(i = 0; i < _count; i++) {
+    _tiles[i]->dirty = true;
+  }
+}
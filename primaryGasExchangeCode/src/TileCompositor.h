@@ -0,0 +1,55 @@
+#ifndef _TILECOMPOSITOR_H_
+#define _TILECOMPOSITOR_H_
+
+#include "Particle.h"
+#include <Adafruit_GFX.h>
+#include <Adafruit_SPITFT.h>
+
+const int MAX_TILES = 8;
+
+// A GFXcanvas16 that notices when it has been drawn on. Every GFX primitive ends up in one of
+// these four, so nothing can change the pixels without setting the flag.
+class Tile : public GFXcanvas16 {
+
+  public:
+    int16_t screenX, screenY;
+    bool dirty;
+
+    Tile(int16_t x, int16_t y, uint16_t w, uint16_t h) : GFXcanvas16(w, h) {
+      screenX = x;
+      screenY = y;
+      dirty = true;
+    }
+    void drawPixel(int16_t x, int16_t y, uint16_t color) { GFXcanvas16::drawPixel(x, y, color); dirty = true; }
+    void fillScreen(uint16_t color) { GFXcanvas16::fillScreen(color); dirty = true; }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { GFXcanvas16::drawFastVLine(x, y, h, color); dirty = true; }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { GFXcanvas16::drawFastHLine(x, y, w, color); dirty = true; }
+};
+
+// Off-screen tiles for the parts of the screen that change. Widgets draw into a tile in RAM
+// (tile coordinates, 0,0 is the tile's top left corner) and flush() sends every tile that
+// changed to the display as one setAddrWindow + writePixels burst.
+//
+// Tiles are allocated up front against a byte budget. A tile that would go over the budget
+// (or that malloc can't satisfy) is refused with -1 and the caller keeps drawing straight
+// to the display, so a smaller budget only costs speed, never a missing readout.
+class TileCompositor {
+
+  Adafruit_SPITFT *_tft;
+  Tile *_tiles[MAX_TILES];
+  int _count;
+  size_t _budget;
+  size_t _used;
+
+  public:
+    TileCompositor(Adafruit_SPITFT *tft, size_t budgetBytes);
+    ~TileCompositor();
+
+    int addTile(int16_t x, int16_t y, uint16_t w, uint16_t h);
+    Adafruit_GFX *canvas(int id);
+    void flush();
+    void invalidate();
+    size_t bytesUsed() { return _used; }
+};
+
+#endif // _TILECOMPOSITOR_H_
@@ -0,0 +1,132 @@
+#include "TimeSeries.h"
+
+TimeSeries::TimeSeries() {
+  int i;
+
+  for(i = 0; i < SERIES_CHANNELS; i++) {
+    _step[i] = 1.0;
+  }
+  clear();
+}
+
+// Value of one delta step for a channel, e.g. 0.1 for CO2 in ppm. Set before the first append().
+void TimeSeries::setResolution(int channel, float step) {
+  if(channel < 0 || channel >= SERIES_CHANNELS || step <= 0) {
+    return;
+  }
+  _step[channel] = step;
+}
+
+void TimeSeries::clear() {
+  memset(_newest, 0, sizeof(_newest));
+  _newestTime = 0;
+  _head = 0;
+  _count = 0;
+}
+
+// values holds one reading per channel. A reading that isn't a number repeats the last one.
+void TimeSeries::append(uint32_t time, const float *values) {
+  int32_t target;
+  int32_t delta;
+  uint32_t dt;
+  int i;
+
+  if(_count > 0) {
+    _head = (_head + 1 == SERIES_CAPACITY) ? 0 : _head + 1;
+  }
+  dt = (_count > 0) ? time - _newestTime : 0;
+  _dt[_head] = (dt > 0xFFFF) ? 0xFFFF : dt;
+
+  for(i = 0; i < SERIES_CHANNELS; i++) {
+    delta = 0;
+    if(isfinite(values[i])) {
+      target = lroundf(values[i] / _step[i]);
+      delta = (_count > 0) ? target - _newest[i] : 0;
+      if(_count == 0) {
+        _newest[i] = target;
+      }
+    }
+    if(delta > INT16_MAX) {
+      delta = INT16_MAX;
+    }
+    if(delta < INT16_MIN) {
+      delta = INT16_MIN;
+    }
+    _deltas[i][_head] = delta;
+    _newest[i] += delta;
+  }
+  _newestTime = time;
+  if(_count < SERIES_CAPACITY) {
+    _count++;
+  }
+}
+
+float TimeSeries::latest(int channel) {
+  if(channel < 0 || channel >= SERIES_CHANNELS || _count == 0) {
+    return NAN;
+  }
+  return _newest[channel] * _step[channel];
+}
+
+// Min, max and mean of the rows no more than seconds older than the newest one
+bool TimeSeries::window(int channel, uint32_t seconds, SeriesStats *stats) {
+  int32_t value;
+  int32_t low, high;
+  int64_t total;
+  uint32_t age;
+  int slot;
+  int rows;
+
+  if(channel < 0 || channel >= SERIES_CHANNELS || _count == 0) {
+    return false;
+  }
+  value = _newest[channel];
+  low = high = value;
+  total = 0;
+  age = 0;
+  slot = _head;
+  rows = 0;
+  while(rows < _count && age <= seconds) {
+    if(value < low) {
+      low = value;
+    }
+    if(value > high) {
+      high = value;
+    }
+    total += value;
+    rows++;
+    age += _dt[slot];
+    value -= _deltas[channel][slot];
+    slot = (slot == 0) ? SERIES_CAPACITY - 1 : slot - 1;
+  }
+  stats->min = low * _step[channel];
+  stats->max = high * _step[channel];
+  stats->mean = (float)total / rows * _step[channel];
+  stats->count = rows;
+  return true;
+}
+
+// Copies up to maxRows of a channel, newest first, for charts and exports. times may be NULL.
+int TimeSeries::read(int channel, float *values, uint32_t *times, int maxRows) {
+  int32_t value;
+  uint32_t time;
+  int slot;
+  int rows;
+
+  if(channel < 0 || channel >= SERIES_CHANNELS) {
+    return 0;
+  }
+  value = _newest[channel];
+  time = _newestTime;
+  slot = _head;
+  for(rows = 0; rows < _count && rows < maxRows; rows++) {
+    values[rows] = value * _step[channel];
+    if(times != NULL) {
+      times[rows] = time;
+    }
+    time -= _dt[slot];
+    value -= _deltas[channel][slot];
+    slot = (slot == 0) ? SERIES_CAPACITY - 1 : slot - 1;
+  }
+  return rows;
+}
@@ -0,0 +1,48 @@
+#ifndef _TIMESERIES_H_
+#define _TIMESERIES_H_
+
+#include "Particle.h"
+
+const int SERIES_CHANNELS = 7;
+const int SERIES_CAPACITY = 720;   // rows kept, at one row per 10s that's the last 2 hours
+
+struct SeriesStats {
+  float min;
+  float max;
+  float mean;
+  int count;    // rows the window covered
+};
+
+// Fixed size history of every sensor channel, one row per append() with a shared timestamp.
+// Stored as arrays per channel rather than arrays of rows, and each sample is the 16-bit
+// difference from the one before it in the channel's resolution steps (0.1ppm, 0.01C, ...),
+// so a row of 7 channels costs 16 bytes. Only the newest value of each channel is kept
+// whole, queries walk backwards from it.
+//
+// append() is O(1) and overwrites the oldest row once full. A step bigger than a delta can
+// hold is spread over the following rows instead of wrapping.
+class TimeSeries {
+
+  int16_t _deltas[SERIES_CHANNELS][SERIES_CAPACITY];
+  uint16_t _dt[SERIES_CAPACITY];        // seconds since the row before
+  int32_t _newest[SERIES_CHANNELS];     // whole value of the newest row, in steps
+  float _step[SERIES_CHANNELS];
+  uint32_t _newestTime;
+  int _head;                            // slot of the newest row
+  int _count;
+
+  public:
+    TimeSeries();
+
+    void setResolution(int channel, float step);
+    void append(uint32_t time, const float *values);
+    void clear();
+
+    int count() { return _count; }
+    uint32_t newestTime() { return _newestTime; }
+    float latest(int channel);
+    bool window(int channel, uint32_t seconds, SeriesStats *stats);
+    int read(int channel, float *values, uint32_t *times, int maxRows);
+};
+
+#endif // _TIMESERIES_H_
@@ -0,0 +1,111 @@
+#include "TouchEvents.h"
+
+static volatile bool penIRQ = false;
+
+static void penDownISR() {
+  penIRQ = true;
+}
+
+TouchEvents::TouchEvents() {
+  _ts = NULL;
+  _irqPin = -1;
+  _minX = _minY = 0;
+  _maxX = _maxY = 4095;
+  _width = _height = 0;
+  _swapXY = false;
+  _touching = false;
+  _releasedSamples = 0;
+  _head = _tail = 0;
+}
+
+// The TSC2007 pulls PENIRQ low on touch while it is powered down with IRQ on, which is the
+// state every read_touch() leaves it in.
+void TouchEvents::begin(Adafruit_TSC2007 *ts, int irqPin) {
+  _ts = ts;
+  _irqPin = irqPin;
+  pinMode(_irqPin, INPUT);
+  attachInterrupt(_irqPin, penDownISR, FALLING);
+}
+
+// Raw readings between min and max are scaled to 0..width/height. With swapXY the raw Y axis
+// becomes the screen x, which is what the panel needs in landscape (rotation 1).
+void TouchEvents::setCalibration(int minX, int maxX, int minY, int maxY, int width, int height, bool swapXY) {
+  _minX = minX;
+  _maxX = maxX;
+  _minY = minY;
+  _maxY = maxY;
+  _width = width;
+  _height = height;
+  _swapXY = swapXY;
+}
+
+// Call from the main loop. Does no I2C at all unless the pen went down or is still down.
+void TouchEvents::poll() {
+  TS_Point p;
+  int16_t x, y;
+
+  if(!_touching) {
+    if(!penIRQ) {
+      return;
+    }
+    penIRQ = false;
+  }
+
+  p = _ts->getPoint(); // all zero when the two X/Y samples disagree
+  if(p.z < TOUCH_MIN_PRESSURE) {
+    _releasedSamples++;
+    if(_touching && _releasedSamples >= TOUCH_UP_SAMPLES) {
+      _touching = false;
+      penIRQ = false;
+      push(TOUCH_UP, _last.x, _last.y, 0);
+    }
+    return;
+  }
+  _releasedSamples = 0;
+
+  if(_swapXY) {
+    x = map(p.y, _minY, _maxY, 0, _width);
+    y = map(p.x, _minX, _maxX, 0, _height);
+  }
+  else {
+    x = map(p.x, _minX, _maxX, 0, _width);
+    y = map(p.y, _minY, _maxY, 0, _height);
+  }
+
+  if(!_touching) {
+    _touching = true;
+    push(TOUCH_DOWN, x, y, p.z);
+  }
+  else if(abs(x - _last.x) >= TOUCH_MOVE_PIXELS || abs(y - _last.y) >= TOUCH_MOVE_PIXELS) {
+    push(TOUCH_MOVE, x, y, p.z);
+  }
+}
+
+// Returns false when there is nothing left to read
+bool TouchEvents::next(TouchEvent *event) {
+  uint8_t tail = _tail;
+
+  if(tail == _head) {
+    return false;
+  }
+  *event = _queue[tail];
+  _tail = (tail + 1) & (TOUCH_QUEUE_SIZE - 1);
+  return true;
+}
+
+// Drops the event when the queue is full, the consumer is too far behind for it to matter
+bool TouchEvents::push(TouchEventType type, int16_t x, int16_t y, int16_t z) {
+  uint8_t head = _head;
+  uint8_t nextHead = (head + 1) & (TOUCH_QUEUE_SIZE - 1);
+
+  _last.type = type;
+  _last.x = x;
+  _last.y = y;
+  _last.z = z;
+  if(nextHead == _tail) {
+    return false;
+  }
+  _queue[head] = _last;
+  _head = nextHead;
+  return true;
+}
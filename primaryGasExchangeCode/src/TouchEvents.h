@@ -0,0 +1,58 @@
+#ifndef _TOUCHEVENTS_H_
+#define _TOUCHEVENTS_H_
+
+#include "Particle.h"
+#include "Adafruit_TSC2007.h"
+
+const int TOUCH_QUEUE_SIZE = 8;     // power of two
+const int TOUCH_MIN_PRESSURE = 5;   // z1 below this is not a touch
+const int TOUCH_MOVE_PIXELS = 3;    // smaller moves don't make a TOUCH_MOVE
+const int TOUCH_UP_SAMPLES = 2;     // released samples in a row before TOUCH_UP
+
+enum TouchEventType {
+  TOUCH_DOWN,
+  TOUCH_MOVE,
+  TOUCH_UP
+};
+
+// x/y are screen pixels, z is the raw pressure reading
+struct TouchEvent {
+  TouchEventType type;
+  int16_t x;
+  int16_t y;
+  int16_t z;
+};
+
+// Turns TSC2007 samples into debounced down/move/up events. The PENIRQ interrupt only sets a
+// flag, so the I2C bus is left alone until somebody actually touches the panel. poll() samples
+// while the pen is down and pushes events into a single producer/single consumer ring buffer
+// that the rest of the firmware drains with next().
+class TouchEvents {
+
+  Adafruit_TSC2007 *_ts;
+  int _irqPin;
+  int _minX, _maxX, _minY, _maxY;
+  int _width, _height;
+  bool _swapXY;
+
+  bool _touching;
+  int _releasedSamples;
+  TouchEvent _last;
+
+  TouchEvent _queue[TOUCH_QUEUE_SIZE];
+  volatile uint8_t _head;
+  volatile uint8_t _tail;
+
+  bool push(TouchEventType type, int16_t x, int16_t y, int16_t z);
+
+  public:
+    TouchEvents();
+
+    void begin(Adafruit_TSC2007 *ts, int irqPin);
+    void setCalibration(int minX, int maxX, int minY, int maxY, int width, int height, bool swapXY);
+    void poll();
+    bool next(TouchEvent *event);
+    bool isTouching() { return _touching; }
+};
+
+#endif // _TOUCHEVENTS_H_
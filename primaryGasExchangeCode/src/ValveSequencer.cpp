@@ -0,0 +1,130 @@
+#include "ValveSequencer.h"
+
+ValveSequencer::ValveSequencer() {
+  _valveCount = 0;
+  _open = 0;
+  _protocol = NULL;
+  _step = 0;
+  _cycle = 0;
+  _stepStart = 0;
+  _onPhase = NULL;
+}
+
+// Returns the valve number (its bit in ValveStep::valves), or -1 when all are taken
+int ValveSequencer::addValve(int pin) {
+  if(_valveCount >= MAX_VALVES) {
+    return -1;
+  }
+  _pins[_valveCount] = pin;
+  return _valveCount++;
+}
+
+// All valves start closed
+void ValveSequencer::begin() {
+  int i;
+
+  for(i = 0; i < _valveCount; i++) {
+    pinMode(_pins[i], OUTPUT);
+    digitalWrite(_pins[i], LOW);
+  }
+  _open = 0;
+}
+
+// A protocol that repeats forever needs at least one step with a duration, or update() never returns
+void ValveSequencer::start(const ValveProtocol *protocol) {
+  uint32_t total = 0;
+  int i;
+
+  if(protocol == NULL || protocol->stepCount == 0) {
+    return;
+  }
+  for(i = 0; i < protocol->stepCount; i++) {
+    total += protocol->steps[i].duration;
+  }
+  if(total == 0 && protocol->cycles == 0) {
+    return;
+  }
+  _protocol = protocol;
+  _cycle = 0;
+  _stepStart = millis();
+  enterStep(0);
+}
+
+// Ends the protocol with every valve closed. Only a protocol that was running reports the
+// change to PHASE_IDLE, stopping an idle sequencer just closes the valves.
+void ValveSequencer::stop() {
+  setValves(0);
+  if(_protocol == NULL) {
+    return;
+  }
+  _protocol = NULL;
+  _step = 0;
+  if(_onPhase != NULL) {
+    _onPhase(PHASE_IDLE);
+  }
+}
+
+void ValveSequencer::update() {
+  unsigned int now = millis();
+
+  // Catches up step by step if a pass was late, every phase change is still reported
+  while(_protocol != NULL && now - _stepStart >= _protocol->steps[_step].duration) {
+    _stepStart += _protocol->steps[_step].duration;
+    if(_step + 1 < _protocol->stepCount) {
+      enterStep(_step + 1);
+    }
+    else if(_protocol->cycles == 0 || _cycle + 1 < _protocol->cycles) {
+      _cycle++;
+      enterStep(0);
+    }
+    else {
+      stop();
+    }
+  }
+}
+
+// Drives the valves directly. Doesn't stop a running protocol, its next step overrides this.
+void ValveSequencer::setValves(uint8_t valves) {
+  uint8_t changed = valves ^ _open;
+  int i;
+
+  for(i = 0; i < _valveCount; i++) {
+    if(changed & (1 << i)) {
+      digitalWrite(_pins[i], (valves & (1 << i)) ? HIGH : LOW);
+    }
+  }
+  _open = valves;
+}
+
+ValvePhase ValveSequencer::phase() {
+  if(_protocol == NULL) {
+    return PHASE_IDLE;
+  }
+  return (ValvePhase)_protocol->steps[_step].phase;
+}
+
+// ms left in the current step
+unsigned int ValveSequencer::stepRemaining() {
+  unsigned int elapsed;
+
+  if(_protocol == NULL) {
+    return 0;
+  }
+  elapsed = millis() - _stepStart;
+  if(elapsed >= _protocol->steps[_step].duration) {
+    return 0;
+  }
+  return _protocol->steps[_step].duration - elapsed;
+}
+
+// The phase callback only fires when the phase actually changes, steps inside a phase are quiet
+void ValveSequencer::enterStep(int step) {
+  uint8_t lastPhase = (_step < _protocol->stepCount) ? _protocol->steps[_step].phase : (uint8_t)PHASE_IDLE;
+  bool first = (step == 0 && _cycle == 0);
+
+  _step = step;
+  setValves(_protocol->steps[step].valves);
+  if(_onPhase != NULL && (first || _protocol->steps[step].phase != lastPhase)) {
+    _onPhase((ValvePhase)_protocol->steps[step].phase);
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef _VALVESEQUENCER_H_
+#define _VALVESEQUENCER_H_
+
+#include "Particle.h"
+
+const int MAX_VALVES = 8;   // one bit each in ValveStep::valves
+
+enum ValvePhase {
+  PHASE_IDLE,
+  PHASE_PURGE,
+  PHASE_EQUILIBRATE,
+  PHASE_MEASURE,
+  PHASE_VENT
+};
+
+// One row of a protocol: which valves are open (bit n = valve n) and for how long
+struct ValveStep {
+  uint8_t valves;
+  uint8_t phase;        // a ValvePhase
+  uint32_t duration;    // ms
+};
+
+// A protocol is a table of steps, run cycles times over (0 = until stopped)
+struct ValveProtocol {
+  const char *name;
+  const ValveStep *steps;
+  uint8_t stepCount;
+  uint16_t cycles;
+};
+
+// Runs valve protocols without blocking. update() is called from loop() and only looks at
+// millis(), so a step ends within one loop pass of its time. Steps are timed from when the
+// previous one was due rather than when it was noticed, so a slow pass doesn't push the rest
+// of the cycle back. Only the valves that change are written.
+class ValveSequencer {
+
+  int _pins[MAX_VALVES];
+  int _valveCount;
+  uint8_t _open;                    // valves open right now
+  const ValveProtocol *_protocol;
+  int _step;
+  uint16_t _cycle;
+  unsigned int _stepStart;
+  void (*_onPhase)(ValvePhase phase);
+
+  void enterStep(int step);
+
+  public:
+    ValveSequencer();
+
+    int addValve(int pin);
+    void begin();
+    void onPhase(void (*callback)(ValvePhase phase)) { _onPhase = callback; }
+
+    void start(const ValveProtocol *protocol);
+    void stop();
+    void update();
+    void setValves(uint8_t valves);
+
+    bool running() { return _protocol != NULL; }
+    uint8_t valves() { return _open; }
+    ValvePhase phase();
+    int step() { return _step; }
+    uint16_t cycle() { return _cycle; }
+    unsigned int stepRemaining();
+};
+
+#endif // _VALVESEQUENCER_H_
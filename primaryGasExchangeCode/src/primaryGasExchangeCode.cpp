@@ -23,9 +23,24 @@
 #include "../lib/Adafruit_BusIO_Register/src/Adafruit_BusIO_Register.h"
 #include "../lib/Adafruit_HDC302x/src/Adafruit_HDC302x.h"
 #include "../lib/Adafruit_VEML7700/src/Adafruit_VEML7700.h"
+#include "TaskScheduler.h"
+#include "TouchEvents.h"
+#include "NumberField.h"
+#include "TileCompositor.h"
+#include "DisplayBenchmark.h"
+#include "Instrumentation.h"
+#include "AnalogSampler.h"
+#include "AnalogCal.h"
+#include "TimeSeries.h"
+#include "ValveSequencer.h"
+#include "FluxEngine.h"
+#include "Telemetry.h"
+#include "PublishQueue.h"
+#include "SampleLog.h"
 
 
 SYSTEM_MODE(SEMI_AUTOMATIC);
+SYSTEM_THREAD(ENABLED); // connecting and publishing don't hold up loop()
 
 // Constants
 const int TFT_DC = D5;
@@ -47,13 +62,98 @@ const int SOLENOID_1PIN = D6;
 const int SOLENOID_2PIN = D10;
 const int SOLENOID_3PIN = D19;
 
+// Valve bits in a ValveStep, in the order initSolenoidValves() adds them
+const uint8_t VALVE_INLET = 1 << 0;     // SOLENOID_1PIN, supply air into the chamber
+const uint8_t VALVE_OUTLET = 1 << 1;    // SOLENOID_2PIN, chamber out to vent
+const uint8_t VALVE_ANALYZER = 1 << 2;  // SOLENOID_3PIN, chamber loop through the LI-COR
+
+const uint8_t VALVES_ALL = VALVE_INLET | VALVE_OUTLET | VALVE_ANALYZER;
+
+// One closed chamber measurement: flush with supply air, close up and let the loop settle,
+// measure the CO2 drawdown, then vent. 4 minutes a cycle, 15 an hour.
+// Placeholder config: the valve roles and step times are a starting point, not yet checked
+// against the real plumbing or the chamber's flush and settling times.
+const ValveStep CHAMBER_CYCLE_STEPS[] = {
+  {VALVE_INLET | VALVE_OUTLET | VALVE_ANALYZER, PHASE_PURGE,        60000},
+  {VALVE_ANALYZER,                              PHASE_EQUILIBRATE,  30000},
+  {VALVE_ANALYZER,                              PHASE_MEASURE,     120000},
+  {VALVE_OUTLET,                                PHASE_VENT,         30000}
+};
+const ValveProtocol CHAMBER_CYCLE = {"chamber cycle", CHAMBER_CYCLE_STEPS, 4, 0};
+
+// Chamber geometry for the flux, set these for the chamber and leaf in use
+const float CHAMBER_VOLUME = 0.0004;  // m^3, chamber plus the analyzer loop
+const float LEAF_AREA = 0.0006;       // m^2 enclosed
+const unsigned int FLUX_WINDOW = 120000; // ms of the measure phase that go into the fit
+
 const int LICORINPUTPIN = A5;
 const int TC_PIN = A2;
 
+// Auto measurement rate both HDC302x start in, 0.5MPS up to 10MPS
+const hdcAutoMode_t HDC_AUTO_MODE = AUTO_MEASUREMENT_1MPS_LP0;
+// The chamber sensor's rate while the chamber is closed and measuring, to follow the transient
+const hdcAutoMode_t HDC_MEASURE_MODE = AUTO_MEASUREMENT_4MPS_LP0;
+
+// Task periods in ms
+const int TOUCH_PERIOD = 10;
+const unsigned int VALVE_HOLD = 2000; // ms a menu zone is held for the manual all open/closed override
+const int CO2_PERIOD = 100; // one fresh AnalogSampler window each time
+const int LUX_PERIOD = 25; // starting point, follows the VEML7700 integration time after that
+const int LEAF_TEMP_PERIOD = 1000;
+const int REDRAW_PERIOD = 1000;
+const int TELEMETRY_PERIOD = 100;
+const int RECORD_PERIOD = 10000; // history and cloud row rate, SERIES_CAPACITY rows of this is 2 hours
+const int PUBLISH_PERIOD = 1000;
+const unsigned int PUBLISH_MAX_AGE = 300000; // ms a row may wait for its event to fill up
+
+// Where the sample log lives on the flash file system. The host build points it at its
+// working directory.
+#ifndef SAMPLE_LOG_PATH
+#define SAMPLE_LOG_PATH "/usr/samples.log"
+#endif
+
+// Binary frames (Telemetry.h) go out on Serial, decode them with tools/telemetry_decode.py.
+// Over USB the baud rate is only nominal, it sets the speed when Serial1 is used instead.
+const long TELEMETRY_BAUD = 115200;
+
+// Sensor channels, the order values go into history.append() and the telemetry frames
+const int SERIES_CO2 = 0;
+const int SERIES_LUX = 1;
+const int SERIES_LEAF_TEMP = 2;
+const int SERIES_BASE_TEMP = 3;
+const int SERIES_BASE_RH = 4;
+const int SERIES_CHAMBER_TEMP = 5;
+const int SERIES_CHAMBER_RH = 6;
+
+// Telemetry frames carry the history channels, then what the lux auto ranging settled on for
+// the reading: raw ALS counts, the VEML7700_GAIN_* code and the integration time in ms
+const int TELEMETRY_LUX_ALS = SERIES_CHANNELS;
+const int TELEMETRY_LUX_GAIN = SERIES_CHANNELS + 1;
+const int TELEMETRY_LUX_IT = SERIES_CHANNELS + 2;
+const int TELEMETRY_CHANNELS = SERIES_CHANNELS + 3;
+
+// Decimals kept per channel, in the history and the cloud events. Well under sensor noise and
+// a full scale jump stays within a few history rows.
+const int SERIES_DECIMALS[SERIES_CHANNELS] = {1, 0, 2, 2, 2, 2, 2};
+static_assert(PUBLISH_CHANNELS == SERIES_CHANNELS, "cloud rows carry every history channel");
+
+// RAM (bytes) the off-screen tiles may take. All seven readouts need 33696, whatever
+// doesn't fit is drawn straight to the display. 0 turns the tiles off.
+const int TILE_BUDGET = 40000;
+
+// Uncomment to time the display at boot, the LargerThanLife suite plus our own screens.
+// The report goes to Serial. For pixels/s and bytes/s also uncomment SPITFT_STATS in
+// lib/Adafruit_GFX_RK/src/Adafruit_SPITFT.h, it changes the class so it can't be set here.
+// #define DISPLAY_BENCHMARK
+
+// Loop, bus and task timing is built in when INSTRUMENTATION is defined in
+// lib/InstrumentationHooks/src/InstrumentationHooks.h.
+// Send 's' over Serial for the per-phase CSV, 'r' for the last spans, 'z' to start over.
+
 // Variables
 int16_t min_x, max_x, min_y, max_y;
-
-static unsigned int lastPrint;
+int hdcTaskId;
+int luxTaskId;
 
 float baseTempReading;
 double baseRHReading;
@@ -67,6 +167,7 @@ int dataOriginLeafTemp = 345;
 int dataOriginBaseTH = 76;
 int dataOriginLeafTH = 278;
 float luxReading;
+veml7700_sample_t luxSample; // last lux reading and the gain/IT that produced it
 float co2Val;
 
 
@@ -74,55 +175,252 @@ float co2Val;
 
 // Function Declarations
 void hdc302xInit(int address_1, int address_2);
+void setHDCRate(Adafruit_HDC302x *sensor, hdcAutoMode_t mode);
 void displayInit();
 void initVEML7700();
 void initSolenoidValves(const int S1_PIN, const int S2_PIN, const int S3_PIN);
+void valvePhaseChanged(ValvePhase phase);
 void layoutHomeScreen();
 void readTS();
+int menuZone(const TouchEvent *event);
 float getThermoTemp();
 float getCO2();
-float intoVolts(int bits);
 float getLux();
 void get_HDC_T_H(float *base_T, double *base_RH, float *chamber_T, double *chamber_RH);
 void display_T_H(float bTemperature, float cTemperature, double bHum, double cHum);
 void displayLeafData(float co2, float lux, float leaftTemp);
+void initTasks();
+void updateCO2();
+void updateLux();
+void updateLeafTemp();
+void updateHDC();
+void redrawData();
+void currentReadings(float *row);
+void sendTelemetry();
+void recordData();
+void initHistory();
+void publishData();
+void restoreCloudQueue();
+void flushLog(system_event_t event, int param);
+bool cloudPublish(const char *event, const char *data);
+void initTiles();
+void runDisplayBenchmark();
 
 // Class Objects
 Adafruit_HDC302x base_T_H = Adafruit_HDC302x();
 Adafruit_HDC302x chamber_T_H = Adafruit_HDC302x();
 Adafruit_HX8357 tft(TFT_CS, TFT_DC, TFT_RST); // for board 0 add the following: HX8357D, &SPI
 Adafruit_TSC2007 ts; // newer rev 2 touch contoller
-TS_Point p;
+TouchEvents touch;
 Adafruit_VEML7700_ luxSensor;
+TaskScheduler scheduler;
+
+// Readouts on the home screen, 5 cells fit the top boxes, 6 the T/RH boxes
+NumberField co2Field(&tft, 115, 80, 5, 3, HX8357_WHITE, HX8357_BLACK);
+NumberField luxField(&tft, 230, 80, 5, 3, HX8357_WHITE, HX8357_BLACK);
+NumberField leafTempField(&tft, 365, 80, 5, 3, HX8357_WHITE, HX8357_BLACK);
+NumberField baseTempField(&tft, 135, 202, 6, 3, HX8357_WHITE, HX8357_BLACK);
+NumberField baseRHField(&tft, 135, 282, 6, 3, HX8357_WHITE, HX8357_BLACK);
+NumberField chamberTempField(&tft, 320, 202, 6, 3, HX8357_WHITE, HX8357_BLACK);
+NumberField chamberRHField(&tft, 320, 282, 6, 3, HX8357_WHITE, HX8357_BLACK);
+NumberField *dashFields[] = {&co2Field, &luxField, &leafTempField, &baseTempField, &baseRHField, &chamberTempField, &chamberRHField};
+TileCompositor tiles(&tft, TILE_BUDGET);
+AnalogSampler analogIn;
+int co2Channel;
+int leafTempChannel;
+AnalogCal co2Cal = CO2_CAL;            // analogTrim() these against a reference to calibrate
+AnalogCal leafTempCal = LEAF_TEMP_CAL;
+TimeSeries history;
+ValveSequencer valves;
+FluxEngine flux(CHAMBER_VOLUME, LEAF_AREA, FLUX_WINDOW);
+FluxResult lastFlux;
+Telemetry telemetry(&Serial);
+TelemetryText instrText(&telemetry); // Instrumentation dumps, as TEXT frames between the samples
+PublishQueue cloudQueue("gasExchange", cloudPublish, PUBLISH_MAX_AGE);
+SampleLog sampleLog(SAMPLE_LOG_PATH);
 
 // Start of the program
 void setup() {
-  Serial.begin(9600);
+  Serial.begin(TELEMETRY_BAUD);
   waitFor(Serial.isConnected, 5000);
   hdc302xInit(0x44, 0x47);
   displayInit();
+  initTiles();
   initVEML7700();
   layoutHomeScreen();
+#ifdef DISPLAY_BENCHMARK
+  runDisplayBenchmark();
+  layoutHomeScreen();
+#endif
   initSolenoidValves(SOLENOID_1PIN, SOLENOID_2PIN, SOLENOID_3PIN);
-  pinMode(LICORINPUTPIN, INPUT);
-  pinMode(TC_PIN, INPUT);
+  co2Channel = analogIn.addChannel(LICORINPUTPIN);
+  leafTempChannel = analogIn.addChannel(TC_PIN);
+  analogIn.begin();
   delay(2000);
+  initHistory();
+  if(!sampleLog.begin()){
+    telemetry.sendText(millis(), "Sample log unavailable, rows won't be kept on flash");
+  }
+  else{
+    restoreCloudQueue();
+  }
+  System.on(reset, flushLog);
+  initTasks();
+  Particle.connect();
 }
 
 void loop() {
+  INSTR_START(INSTR_LOOP);
+  valves.update();
+  scheduler.run();
+  INSTR_STOP(INSTR_LOOP, 0);
+  INSTR_POLL(&Serial, &instrText);
+}
+
+// Each job runs at its own rate. Priority decides who goes first when several are due,
+// the deadline (ms late) lets a starved job jump the queue.
+void initTasks(){
+  scheduler.addTask(readTS, TOUCH_PERIOD, 10, 5);
+  hdcTaskId = scheduler.addTask(updateHDC, Adafruit_HDC302x::autoModePeriod(HDC_AUTO_MODE), 5, 500);
+  scheduler.addTask(updateCO2, CO2_PERIOD, 5, 500);
+  luxTaskId = scheduler.addTask(updateLux, LUX_PERIOD, 4, 500);
+  scheduler.addTask(updateLeafTemp, LEAF_TEMP_PERIOD, 4, 500);
+  scheduler.addTask(redrawData, REDRAW_PERIOD, 2, 1000);
+  scheduler.addTask(sendTelemetry, TELEMETRY_PERIOD, 1, 200);
+  scheduler.addTask(recordData, RECORD_PERIOD, 3, 1000);
+  scheduler.addTask(publishData, PUBLISH_PERIOD, 1, 5000);
+}
+
+void initHistory(){
+  int i;
+
+  for(i = 0; i < SERIES_CHANNELS; i++){
+    history.setResolution(i, powf(10, -SERIES_DECIMALS[i]));
+    cloudQueue.setDecimals(i, SERIES_DECIMALS[i]);
+  }
+}
+
+// Every fresh window goes into the flux fit while the chamber is measuring. Nothing until the
+// sampler's first window has filled, a partial sum would read low.
+void updateCO2(){
+  INSTR_SPAN(INSTR_CO2);
+  if(!analogIn.ready()){
+    return;
+  }
+  co2Val = getCO2();
+  if(valves.phase() == PHASE_MEASURE){
+    flux.add(millis(), co2Val, chamberTempReading, chamberRHReading);
+  }
+}
+
+// Polls again as soon as the integration running with the current range is done
+void updateLux(){
+  INSTR_SPAN(INSTR_LUX);
+  luxReading = getLux();
+  scheduler.setPeriod(luxTaskId, Adafruit_VEML7700_::integrationTimeMs(luxSensor.getIntegrationTime()));
+}
+
+void updateLeafTemp(){
+  INSTR_SPAN(INSTR_LEAF);
+  if(!analogIn.ready()){
+    return;
+  }
+  leafThermoTemp = getThermoTemp();
+}
+
+void updateHDC(){
+  INSTR_SPAN(INSTR_HDC);
+  get_HDC_T_H(&baseTempReading, &baseRHReading, &chamberTempReading, &chamberRHReading); //Returns the Base & the Chamber Temp+Hum
+}
+
+// The fields draw into their tiles, flush() then sends only the tiles that changed
+void redrawData(){
+  INSTR_SPAN(INSTR_REDRAW);
+  displayLeafData(co2Val, luxReading, leafThermoTemp);
+  display_T_H(baseTempReading, chamberTempReading, baseRHReading, chamberRHReading);
+  tiles.flush();
+}
+
+// One row of every channel into the history
+void recordData(){
+  float row[SERIES_CHANNELS];
+  uint32_t sequence = sampleLog.next();
+
+  currentReadings(row);
+  history.append(millis() / 1000, row);
+  sampleLog.append(Time.isValid() ? Time.now() : 0, millis(), row, SERIES_CHANNELS);
+  cloudQueue.add(millis(), row, sequence);
+}
+
+// Rows on flash the cloud never got before the reset go back in the queue, at most as many as
+// it holds. Rows from before the clock was synced have no time to publish them with, they
+// stay on flash only.
+void restoreCloudQueue(){
+  float row[SERIES_CHANNELS];
+  LogRecord record;
+  uint32_t sequence = sampleLog.marked();
+  int i;
+
+  if(sequence > sampleLog.next()){
+    return;
+  }
+  if(sampleLog.next() - sequence > PUBLISH_QUEUE_ROWS){
+    sequence = sampleLog.next() - PUBLISH_QUEUE_ROWS;
+  }
+  if(sequence < sampleLog.oldest()){
+    sequence = sampleLog.oldest();
+  }
+  for(; sequence < sampleLog.next(); sequence++){
+    if(!sampleLog.read(sequence, &record) || record.time == 0){
+      continue;
+    }
+    for(i = 0; i < SERIES_CHANNELS; i++){
+      row[i] = (i < record.count && record.values[i] != INT32_MIN) ? record.values[i] / 1000.0 : NAN;
+    }
+    cloudQueue.restore(record.time, row, sequence);
+  }
+}
 
-  readTS();
-  if((millis() - lastPrint) > 1000){
-    co2Val = getCO2();
-    luxReading = getLux();
-    leafThermoTemp = getThermoTemp();
-    displayLeafData(co2Val, luxReading, leafThermoTemp);
-    display_T_H(baseTempReading, chamberTempReading, baseRHReading, chamberRHReading);
-    Serial.printf("Base Temp: %0.1f\nBase RH: %0.1f\nChamber Temp: %0.1f\nChamber RH: %0.1f\nleaf temp: %0.1f\n", baseTempReading, baseRHReading, chamberTempReading, chamberRHReading, leafThermoTemp);
-    lastPrint = millis();
+// Rows still queued for the log's writer thread go to flash before a planned reset
+void flushLog(system_event_t, int){
+  sampleLog.flush();
+}
+
+// Row times become wall clock time here, so nothing goes out before the clock is synced. The
+// log keeps how far the cloud has got, for restoreCloudQueue() after a reset.
+void publishData(){
+  if(cloudQueue.update(Particle.connected() && Time.isValid(), millis(), Time.now())){
+    sampleLog.mark(cloudQueue.published());
   }
 }
 
+// NO_ACK returns once the event is sent instead of waiting on the cloud's reply
+bool cloudPublish(const char *event, const char *data){
+  return Particle.publish(event, data, PRIVATE, NO_ACK);
+}
+
+// Latest value of every channel, in SERIES_ order
+void currentReadings(float *row){
+  row[SERIES_CO2] = co2Val;
+  row[SERIES_LUX] = luxReading;
+  row[SERIES_LEAF_TEMP] = leafThermoTemp;
+  row[SERIES_BASE_TEMP] = baseTempReading;
+  row[SERIES_BASE_RH] = baseRHReading;
+  row[SERIES_CHAMBER_TEMP] = chamberTempReading;
+  row[SERIES_CHAMBER_RH] = chamberRHReading;
+}
+
+// 52 bytes a frame with all ten channels, 4.5ms on the wire at 115200 baud
+void sendTelemetry(){
+  float row[TELEMETRY_CHANNELS];
+
+  currentReadings(row);
+  row[TELEMETRY_LUX_ALS] = luxSample.als;
+  row[TELEMETRY_LUX_GAIN] = luxSample.gain;
+  row[TELEMETRY_LUX_IT] = Adafruit_VEML7700_::integrationTimeMs(luxSample.integrationTime);
+  telemetry.send(millis(), row, TELEMETRY_CHANNELS);
+}
+
 // Use address 0x44 for address_1 and 0x47 for address_2
 void hdc302xInit(int baseAddress, int chamberAddress){
   if(!base_T_H.begin(baseAddress)){
@@ -133,6 +431,27 @@ void hdc302xInit(int baseAddress, int chamberAddress){
     //Serial.printf("Could not find chamber temp/hum sensor?");
     //while (1);
   }
+  base_T_H.setAutoMode(HDC_AUTO_MODE);
+  chamber_T_H.setAutoMode(HDC_AUTO_MODE);
+}
+
+// Changes the auto measurement rate of one sensor, e.g. to sample faster during a transient.
+// The readout task follows the faster of the two sensors.
+void setHDCRate(Adafruit_HDC302x *sensor, hdcAutoMode_t mode){
+  unsigned int readoutPeriod, chamberPeriod;
+
+  if(sensor->getAutoMode() == mode){
+    return;
+  }
+  sensor->setAutoMode(mode);
+  readoutPeriod = Adafruit_HDC302x::autoModePeriod(base_T_H.getAutoMode());
+  chamberPeriod = Adafruit_HDC302x::autoModePeriod(chamber_T_H.getAutoMode());
+  if(readoutPeriod == 0 || (chamberPeriod != 0 && chamberPeriod < readoutPeriod)){
+    readoutPeriod = chamberPeriod;
+  }
+  if(readoutPeriod != 0){
+    scheduler.setPeriod(hdcTaskId, readoutPeriod);
+  }
 }
 
 // Use address 0x48 for screenAddress
@@ -143,26 +462,59 @@ void displayInit(){
   else{
     //Serial.printf("Touchscreen started\n");
   }
+  // z2 is never used and TouchEvents debounces pen up, so one X/Y/Z1 conversion each is enough
+  ts.setSamplingProfile(TSC2007_SAMPLE_FAST);
 
   tft.begin();
   tft.setRotation(1);
   min_x = TS_MINX; max_x = TS_MAXX;
   min_y = TS_MINY; max_y = TS_MAXY;
-  pinMode(TSC_IRQ, INPUT);
+  touch.begin(&ts, TSC_IRQ);
+  touch.setCalibration(TS_MINX, TS_MAXX, TS_MINY, TS_MAXY, tft.width(), tft.height(), true);
   
 }
 
 
 
+// Gives each readout its own off-screen tile while the budget lasts
+void initTiles(){
+  int id;
+
+  for(unsigned int i = 0; i < sizeof(dashFields) / sizeof(dashFields[0]); i++){
+    id = tiles.addTile(dashFields[i]->x(), dashFields[i]->y(), dashFields[i]->width(), dashFields[i]->height());
+    if(id >= 0){
+      dashFields[i]->setTarget(tiles.canvas(id), 0, 0);
+    }
+  }
+}
+
 // Sets pinModes and initializes each solenoid to the LOW mode
 void initSolenoidValves(const int S1_PIN, const int S2_PIN, const int S3_PIN){
-  pinMode(S1_PIN, OUTPUT);
-  pinMode(S2_PIN, OUTPUT);
-  pinMode(S3_PIN, OUTPUT);
+  valves.addValve(S1_PIN);
+  valves.addValve(S2_PIN);
+  valves.addValve(S3_PIN);
+  valves.begin();
+  valves.onPhase(valvePhaseChanged);
+}
 
-  digitalWrite(S1_PIN, LOW);
-  digitalWrite(S2_PIN, LOW);
-  digitalWrite(S3_PIN, LOW);
+// Phase changes and each finished flux fit go out as their own telemetry frames
+void valvePhaseChanged(ValvePhase phase){
+  float fit[5];
+
+  telemetry.sendPhase(millis(), phase, valves.cycle());
+  setHDCRate(&chamber_T_H, (phase == PHASE_MEASURE) ? HDC_MEASURE_MODE : HDC_AUTO_MODE);
+  if(phase == PHASE_MEASURE){
+    flux.begin(millis());
+  }
+  else if(flux.result(&lastFlux)){
+    fit[0] = lastFlux.flux;
+    fit[1] = lastFlux.slope;
+    fit[2] = lastFlux.r2;
+    fit[3] = lastFlux.seconds;
+    fit[4] = lastFlux.samples;
+    telemetry.sendFlux(millis(), fit, 5);
+    flux.begin(millis()); // reported once
+  }
 }
 
 void initVEML7700(){
@@ -172,8 +524,9 @@ void initVEML7700(){
   else{
     //Serial.printf("VEML up and running!\n");
   }
+  // Starting point for auto ranging, readLuxAuto() moves gain/IT from here
   luxSensor.setGain(VEML7700_GAIN_1_8);
-  luxSensor.setIntegrationTime(VEML7700_IT_100MS);
+  luxSensor.setIntegrationTime(VEML7700_IT_25MS);
 }
 
 // Draws the shapes that outlines the home screen
@@ -224,137 +577,144 @@ void layoutHomeScreen(){
   tft.printf("Chamber TempC\r");
   tft.setCursor(307, 242);
   tft.printf("Chamber RH%c\r", 0x25);
+
+  // The screen was just cleared, so every readout has to be drawn in full again
+  for(unsigned int i = 0; i < sizeof(dashFields) / sizeof(dashFields[0]); i++){
+    dashFields[i]->invalidate();
+  }
+  tiles.invalidate();
 }
 
-// Get X, Y, & pressure values
+// Menu zone under a touch: 1 green, 2 red, 0 neither
+int menuZone(const TouchEvent *event){
+  if((event->x > 0) && (event->x < 80)){
+    if((event->y > 160) && (event->y < 320)){
+      return 1;
+    }
+    if((event->y > 0) && (event->y < 160)){
+      return 2;
+    }
+  }
+  return 0;
+}
+
+// Samples the panel (only while touched) and acts on each new touch. A tap on green starts the
+// chamber cycle, red stops it and closes everything. Holding either for VALVE_HOLD is the manual
+// override the panel had before the sequencer: green opens all valves, red closes them, with no
+// protocol running.
 void readTS(){
-  if (digitalRead(TSC_IRQ)){   // IRQ pin is high, nothing to read!
-    return;
+  INSTR_SPAN(INSTR_TOUCH);
+  static int heldZone = 0;
+  static unsigned int heldSince;
+  TouchEvent event;
+
+  touch.poll();
+  while(touch.next(&event)){
+    //Serial.printf("X: %i\nY: %i\nPressure: %i\n", event.x, event.y, event.z);
+    if(event.type == TOUCH_UP || (event.type == TOUCH_MOVE && menuZone(&event) != heldZone)){
+      heldZone = 0;
+      continue;
+    }
+    if(event.type != TOUCH_DOWN){
+      continue;
+    }
+    heldZone = menuZone(&event);
+    heldSince = millis();
+    //Green path
+    if(heldZone == 1){
+      valves.start(&CHAMBER_CYCLE);
+    }
+    // Red path
+    else if(heldZone == 2){
+      valves.stop();
+    }
   }
-  p = ts.getPoint();
-  //Scale from ~0->4000 to tft.width using the calibration #'s
-  p.y = map(p.y, TS_MINY, TS_MAXY, 0, tft.width());
-  p.x = map(p.x, TS_MINX, TS_MAXX, 0, tft.height());
-  if(p.z > 5){
-    //Serial.printf("X: %i\nY: %i\nPressure: %i\n", p.x, p.y, p.z);
-    //Green path 
-    if((p.y > 0) && (p.y < 80)){
-      if((p.x > 160) && (p.x < 320)){
-        //Serial.printf("Opening  all solenoids\n");
-        digitalWrite(SOLENOID_1PIN, HIGH);
-        digitalWrite(SOLENOID_2PIN, HIGH);
-        digitalWrite(SOLENOID_3PIN, HIGH);
-        //delay(5000);
-      }
-      // Red path
-      else if((p.x > 0) && (p.x < 160)){
-        //Serial.printf("Closing all solenoids\n");
-        digitalWrite(SOLENOID_1PIN, LOW);
-        digitalWrite(SOLENOID_2PIN, LOW);
-        digitalWrite(SOLENOID_3PIN, LOW);
-        //delay(5000);
-      }
+
+  if(heldZone != 0 && millis() - heldSince >= VALVE_HOLD){
+    valves.stop();
+    if(heldZone == 1){
+      //Serial.printf("Opening  all solenoids\n");
+      valves.setValves(VALVES_ALL);
     }
+    heldZone = 0;
   }
 }
 
 
+// Both sensors run in auto mode, so this is a bare readout of their latest results
 void get_HDC_T_H(float *base_T, double *base_RH, float *chamber_T, double *chamber_RH){
   double baseTemp, chamberTemp;
 
-  base_T_H.readTemperatureHumidityOnDemand(baseTemp, *base_RH,TRIGGERMODE_LP0);
-  chamber_T_H.readTemperatureHumidityOnDemand(chamberTemp, *chamber_RH,TRIGGERMODE_LP0);
-  *base_T = baseTemp ;
-  *chamber_T = chamberTemp;
+  if(base_T_H.readAutoTempRH(baseTemp, *base_RH)){
+    *base_T = baseTemp;
+  }
+  if(chamber_T_H.readAutoTempRH(chamberTemp, *chamber_RH)){
+    *chamber_T = chamberTemp;
+  }
   //Serial.printf("Base Temp: %0.1f\nBase RH: %0.1f\nChamber Temp: %0.1f\nChamber RH: %0.1f\n", *base_T, *base_RH, *chamber_T, *chamber_RH);
   
 }
 
+// Both analog inputs are read from the background sampler's 100 sample sum and converted in
+// fixed point, float only comes in for the final value
 float getThermoTemp(){
-  int reading;
-  float voltage;
-  float tempC;
+  int32_t milliC;
 
-  reading = analogRead(TC_PIN);
-  voltage = intoVolts(reading);
-  tempC = (voltage - 1.25) / 0.005;
-  return tempC;
+  milliC = analogToMilli(leafTempCal, analogIn.sum(leafTempChannel));
+  return milliC / 1000.0;
 }
   
 float getCO2(){
-  int measuredBits;
-  float measuredVolts;
-  float co2Concentration;
+  int32_t milliPpm;
 
-  measuredBits = analogRead(LICORINPUTPIN);
-  measuredVolts = intoVolts(measuredBits);
-  co2Concentration = 2000*(measuredVolts/5.0);
-  return co2Concentration;
+  milliPpm = analogToMilli(co2Cal, analogIn.sum(co2Channel));
+  return milliPpm / 1000.0;
 }
 
+// Only the character cells that changed get repainted
 void display_T_H(float bTemperature, float cTemperature, double bHum, double cHum){
-  float lastBTemp;
-  double lastBHum;
-  float lastCTemp;
-  double lastCHum;
-
-  get_HDC_T_H(&baseTempReading, &baseRHReading, &chamberTempReading, &chamberRHReading); //Returns the Base & the Chamber Temp+Hum
-  tft.setTextSize(3);
-  if(lastBTemp != bTemperature){
-    tft.fillRect(135,202,108,24, HX8357_BLACK);
-    lastBTemp = bTemperature;
-  }
-  tft.setCursor(135, 202);
-  tft.printf("%0.1f\r", bTemperature);
-  
-  if(lastBHum != bHum){
-    tft.fillRect(135,282,108,24, HX8357_BLACK);     
-    lastBHum = bHum;
-  }
-  tft.setCursor(135, 282);
-  tft.printf("%0.1f\r", bHum);
-  
-  if(lastCTemp != cTemperature){
-    tft.fillRect(320,202,108,24, HX8357_BLACK);
-    lastCTemp = cTemperature;
-  }
-  tft.setCursor(320, 202);
-  tft.printf("%0.1f\r", cTemperature);
-  
-  if(lastCHum != cHum){
-    tft.fillRect(320,282,108,24, HX8357_BLACK); 
-    lastCHum = cHum;
-  }
-  tft.setCursor(320, 282);
-  tft.printf("%0.1f\r", cHum);
+  baseTempField.print(bTemperature, 1);
+  baseRHField.print(bHum, 1);
+  chamberTempField.print(cTemperature, 1);
+  chamberRHField.print(cHum, 1);
 }
 
 void displayLeafData(float co2, float lux, float leaftTemp){
-  tft.setTextSize(3);
+  co2Field.print(co2, 1);
+  luxField.print(lux, 1);
+  leafTempField.print(leaftTemp, 1);
+}
 
-  tft.fillRect(115, 80, 95, 24, HX8357_BLACK);
-  tft.setCursor(115, 80);
-  tft.printf("%0.1f\r", co2);
+// Keeps the last good reading while the sensor settles on a new range
+float getLux(){
+  luxSensor.readLuxAuto(&luxSample);
+  return luxSample.lux;
+}
 
-  
-  tft.fillRect(230, 80, 95, 24, HX8357_BLACK);
-  tft.setCursor(230, 80);
-  tft.printf("%0.1f\r", lux);
+#ifdef DISPLAY_BENCHMARK
+void benchLayout(Adafruit_SPITFT *display){
+  layoutHomeScreen();
+}
 
-  
-  tft.fillRect(365, 80, 95, 24, HX8357_BLACK);
-  tft.setCursor(365, 80);
-  tft.printf("%0.1f\r", leaftTemp);
+// Every digit of every readout changes, the worst case for one refresh
+void benchReadoutsPrepare(Adafruit_SPITFT *display){
+  displayLeafData(888.8, 888.8, 88.8);
+  display_T_H(88.8, 88.8, 88.8, 88.8);
+  tiles.flush();
 }
 
-float getLux(){
-  return luxSensor.readLux();
+void benchReadouts(Adafruit_SPITFT *display){
+  displayLeafData(412.3, 1034.5, 23.4);
+  display_T_H(21.7, 24.2, 45.1, 61.9);
+  tiles.flush();
 }
 
-float intoVolts(int bits){
-  float result;
+void runDisplayBenchmark(){
+  DisplayBenchmark bench(&tft);
 
-  result = (3.3/4095) * bits;
-  return result;
+  bench.addStandardSuite();
+  bench.add("Home screen layout", benchLayout);
+  bench.add("Readout refresh", benchReadouts, benchReadoutsPrepare);
+  bench.run();
 }
-
+#endif
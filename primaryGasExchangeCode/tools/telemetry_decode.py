@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Turns the firmware's binary telemetry frames (src/Telemetry.h) into CSV.
+
+    python3 telemetry_decode.py capture.bin > readings.csv
+    python3 telemetry_decode.py --port /dev/ttyACM0 > readings.csv   (needs pyserial)
+
+Reads a file, stdin, or a serial port. Frames are COBS encoded and end in 0x00. Sample frames
+become CSV rows on stdout. Valve phase, flux and text frames, and anything between frames that
+isn't a valid frame, go to stderr.
+"""
+
+import argparse
+import struct
+import sys
+
+FRAME_SAMPLE = 0x01
+FRAME_PHASE = 0x02
+FRAME_FLUX = 0x03
+FRAME_TEXT = 0x04
+HEADER = struct.Struct("<BHIB")
+PHASE = struct.Struct("<BH")
+MISSING = -2**31
+
+# Same order as the SERIES_ and TELEMETRY_LUX_ constants in primaryGasExchangeCode.cpp
+CHANNELS = ["co2_ppm", "lux", "leaf_temp_c", "base_temp_c", "base_rh", "chamber_temp_c", "chamber_rh",
+            "lux_als", "lux_gain", "lux_it_ms"]
+
+# ValvePhase in ValveSequencer.h
+PHASES = ["idle", "purge", "equilibrate", "measure", "vent"]
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as Telemetry::crc16."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0:
+            return None
+        block = data[i + 1:i + code]
+        if len(block) != code - 1:
+            return None
+        out += block
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def thousandths(raw, count):
+    milli = struct.unpack_from("<%di" % count, raw, HEADER.size)
+    return [None if v == MISSING else v / 1000.0 for v in milli]
+
+
+def parse(frame):
+    """Returns (type, sequence, ms, body) or None when it isn't a good frame. The body is the
+    list of values for sample and flux frames, (phase, cycle) for a phase and the text for text."""
+    raw = cobs_decode(frame)
+    if raw is None or len(raw) < HEADER.size + 2:
+        return None
+    if crc16(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+        return None
+    kind, sequence, ms, count = HEADER.unpack_from(raw)
+    size = len(raw) - HEADER.size - 2
+    if kind == FRAME_SAMPLE and size == 4 * count:
+        body = thousandths(raw, count)
+    elif kind == FRAME_FLUX and size == 4 * count == 4 * 5:
+        body = thousandths(raw, count)
+    elif kind == FRAME_PHASE and size == PHASE.size == count:
+        body = PHASE.unpack_from(raw, HEADER.size)
+    elif kind == FRAME_TEXT and size == count:
+        body = raw[HEADER.size:-2].decode("ascii", "replace")
+    else:
+        return None
+    return kind, sequence, ms, body
+
+
+def frames(blocks):
+    """Yields (frame, text) for everything in a stream of byte blocks: frame is what parse()
+    returns, or None for text that didn't decode."""
+    pending = bytearray()
+    for block in blocks:
+        pending += block
+        while b"\x00" in pending:
+            data, _, rest = pending.partition(b"\x00")
+            pending = bytearray(rest)
+            # Text printed between frames runs straight into the next one, split it off
+            text = b""
+            frame = parse(bytes(data))
+            cut = data.find(b"\n")
+            while frame is None and cut >= 0:
+                frame = parse(bytes(data[cut + 1:]))
+                if frame is not None:
+                    text, data = data[:cut + 1], data[cut + 1:]
+                cut = data.find(b"\n", cut + 1)
+            if frame is None:
+                text += data
+            text = text.decode("ascii", "replace").strip()
+            if text:
+                yield None, text
+            if frame is not None:
+                yield frame, None
+
+
+def describe(frame):
+    """The stderr line for a frame that isn't a sample."""
+    kind, _, ms, body = frame
+    if kind == FRAME_PHASE:
+        phase, cycle = body
+        name = PHASES[phase] if phase < len(PHASES) else "phase %d" % phase
+        return "%d ms: valves %s (cycle %d)" % (ms, name, cycle)
+    if kind == FRAME_FLUX:
+        flux, slope, r2, seconds, samples = ["?" if v is None else "%g" % v for v in body]
+        return "%d ms: flux %s umol/m2/s, R2 %s, %s ppm/s over %ss (%s samples)" % (
+            ms, flux, r2, slope, seconds, samples)
+    return "%d ms: %s" % (ms, body)
+
+
+def chunks(source, live):
+    """A live port times out with nothing read now and then, a file is done at its end."""
+    while True:
+        block = source.read(256)
+        if not block and not live:
+            return
+        yield block
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("file", nargs="?", help="capture to decode, stdin when left out")
+    parser.add_argument("--port", help="serial port to read live")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        source = serial.Serial(args.port, args.baud, timeout=0.1)
+    elif args.file:
+        source = open(args.file, "rb")
+    else:
+        source = sys.stdin.buffer
+
+    out = sys.stdout
+    header_written = False
+    last_sequence = None
+    lost = 0
+    try:
+        for frame, text in frames(chunks(source, bool(args.port))):
+            if frame is None:
+                sys.stderr.write(text + "\n")
+                continue
+            kind, sequence, ms, body = frame
+            if last_sequence is not None:
+                lost += (sequence - last_sequence - 1) & 0xFFFF
+            last_sequence = sequence
+            if kind != FRAME_SAMPLE:
+                sys.stderr.write(describe(frame) + "\n")
+                continue
+            if not header_written:
+                names = CHANNELS[:len(body)] + ["ch%d" % i for i in range(len(CHANNELS), len(body))]
+                out.write(",".join(["sequence", "ms"] + names) + "\n")
+                header_written = True
+            values = ["" if v is None else "%.3f" % v for v in body]
+            out.write(",".join([str(sequence), str(ms)] + values) + "\n")
+            out.flush()
+    except KeyboardInterrupt:
+        pass
+    if lost:
+        sys.stderr.write("%d frames lost\n" % lost)
+
+
+if __name__ == "__main__":
+    main()